@@ -0,0 +1,90 @@
+#include "BatchInterpreter.h"
+#include "Process.h"
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+std::size_t BatchInterpreter::vectorWidth() {
+#if defined(__AVX2__)
+    return 16;
+#elif defined(__SSE2__) || defined(_M_X64)
+    return 8;
+#else
+    return 1;
+#endif
+}
+
+// out[i] = b[i] +/- c[i] on uint16 lanes
+static void addLanes(const std::uint16_t* b, const std::uint16_t* c, std::uint16_t* out, std::size_t n, bool subtract) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= n; i += 16) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i));
+        __m256i r = subtract ? _mm256_sub_epi16(x, y) : _mm256_add_epi16(x, y);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+        __m128i r = subtract ? _mm_sub_epi16(x, y) : _mm_add_epi16(x, y);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), r);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = static_cast<std::uint16_t>(subtract ? b[i] - c[i] : b[i] + c[i]);
+    }
+}
+
+void BatchInterpreter::runArithmetic(const std::vector<Process*>& group, bool subtract) {
+    std::size_t n = group.size();
+    if (n < vectorWidth()) {
+        // Not enough lanes to fill a vector: plain scalar execution
+        for (Process* proc : group) {
+            const Op& op = proc->currentOp();
+            std::uint16_t b = proc->operandValue(op.b, op.flags & Op::IMM_B);
+            std::uint16_t c = proc->operandValue(op.c, op.flags & Op::IMM_C);
+            proc->retireAlu(static_cast<std::uint16_t>(subtract ? b - c : b + c));
+        }
+        return;
+    }
+
+    srcB.resize(n);
+    srcC.resize(n);
+    result.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const Op& op = group[i]->currentOp();
+        srcB[i] = group[i]->operandValue(op.b, op.flags & Op::IMM_B);
+        srcC[i] = group[i]->operandValue(op.c, op.flags & Op::IMM_C);
+    }
+    addLanes(srcB.data(), srcC.data(), result.data(), n, subtract);
+    for (std::size_t i = 0; i < n; ++i) {
+        group[i]->retireAlu(result[i]);
+    }
+}
+
+void BatchInterpreter::run() {
+    adds.clear();
+    subs.clear();
+    for (Process* proc : lanes) {
+        const Op& op = proc->currentOp();
+        switch (op.code) {
+        case OpCode::Add:
+            adds.push_back(proc);
+            break;
+        case OpCode::Sub:
+            subs.push_back(proc);
+            break;
+        default:
+            // DECLARE is a plain store; nothing to vectorize
+            proc->retireAlu(op.b);
+            break;
+        }
+    }
+    runArithmetic(adds, false);
+    runArithmetic(subs, true);
+    lanes.clear();
+}
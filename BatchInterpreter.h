@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Process;
+
+// Executes the pending DECLARE/ADD/SUB of every process a host stepped this tick in one go.
+// Lanes are grouped by opcode; each group's operands are gathered into structure-of-arrays
+// buffers and run through 16-bit vector adds/subtracts (wrapping, like the scalar interpreter),
+// then written back. Groups too small to fill a vector take the scalar path.
+class BatchInterpreter {
+public:
+    void add(Process* proc) { lanes.push_back(proc); }
+    bool empty() const { return lanes.empty(); }
+    // Executes and retires every queued op, then clears the batch
+    void run();
+
+    // Lanes per vector operation on this build (1 without SIMD)
+    static std::size_t vectorWidth();
+
+private:
+    void runArithmetic(const std::vector<Process*>& group, bool subtract);
+
+    std::vector<Process*> lanes;
+    std::vector<Process*> adds, subs;
+    std::vector<std::uint16_t> srcB, srcC, result;
+};
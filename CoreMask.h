@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Lock-free set of idle cores, one bit per core (1 = idle).
+// Cores are claimed with compare-and-swap so two workers can never take the same core.
+class CoreMask {
+public:
+    explicit CoreMask(int numCores)
+        : numCores(numCores), numWords((numCores + 63) / 64), words(new std::atomic<uint64_t>[(numCores + 63) / 64]) {
+        clearAll();
+    }
+
+    void setAll() {
+        for (int w = 0; w < numWords; ++w) {
+            words[w].store(wordMask(w), std::memory_order_release);
+        }
+    }
+
+    void clearAll() {
+        for (int w = 0; w < numWords; ++w) {
+            words[w].store(0, std::memory_order_release);
+        }
+    }
+
+    // Marks a specific core busy; false if it was already busy
+    bool claim(int core) {
+        std::atomic<uint64_t>& word = words[core / 64];
+        uint64_t bit = uint64_t(1) << (core % 64);
+        uint64_t cur = word.load(std::memory_order_relaxed);
+        while (cur & bit) {
+            if (word.compare_exchange_weak(cur, cur & ~bit, std::memory_order_acq_rel)) return true;
+        }
+        return false;
+    }
+
+    // Claims the lowest idle core, or returns -1 if every core is busy
+    int claimAny() {
+        for (int w = 0; w < numWords; ++w) {
+            uint64_t cur = words[w].load(std::memory_order_relaxed);
+            while (cur != 0) {
+                int bitIdx = lowestSetBit(cur);
+                if (words[w].compare_exchange_weak(cur, cur & ~(uint64_t(1) << bitIdx), std::memory_order_acq_rel)) {
+                    return w * 64 + bitIdx;
+                }
+            }
+        }
+        return -1;
+    }
+
+    // Lowest idle core other than `except`, without claiming it; -1 if none
+    int findIdle(int except = -1) const {
+        for (int w = 0; w < numWords; ++w) {
+            uint64_t cur = words[w].load(std::memory_order_acquire);
+            if (except >= 0 && except / 64 == w) cur &= ~(uint64_t(1) << (except % 64));
+            if (cur != 0) return w * 64 + lowestSetBit(cur);
+        }
+        return -1;
+    }
+
+    void release(int core) {
+        words[core / 64].fetch_or(uint64_t(1) << (core % 64), std::memory_order_release);
+    }
+
+    bool isIdle(int core) const {
+        return (words[core / 64].load(std::memory_order_acquire) >> (core % 64)) & 1;
+    }
+
+    int count() const {
+        int total = 0;
+        for (int w = 0; w < numWords; ++w) {
+            total += popCount(words[w].load(std::memory_order_acquire));
+        }
+        return total;
+    }
+
+private:
+    uint64_t wordMask(int w) const {
+        int bits = numCores - w * 64;
+        return bits >= 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+    }
+
+    static int lowestSetBit(uint64_t v) {
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanForward64(&idx, v);
+        return static_cast<int>(idx);
+#else
+        return __builtin_ctzll(v);
+#endif
+    }
+
+    static int popCount(uint64_t v) {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt64(v));
+#else
+        return __builtin_popcountll(v);
+#endif
+    }
+
+    int numCores;
+    int numWords;
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+};
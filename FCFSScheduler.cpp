@@ -22,9 +22,44 @@ extern int min_mem_per_proc;
 extern int max_mem_per_proc;
 extern int max_overall_mem;
 extern int mem_per_frame;
+extern int page_fault_ticks;
+extern std::string program_generation;
+extern std::string execution_mode;
+extern int ticks_per_step;
+extern std::uint64_t random_seed;
+extern int generator_threads;
+extern int batch_process_size;
+extern int archive_size;
+
+namespace {
+
+// Wall-clock length of one scheduler tick for idle accounting and process generation
+const std::chrono::milliseconds TICK_DURATION(1);
+
+// Simulated time one instruction takes on a core (to catch 100% or 0% cpu utilization)
+const std::chrono::milliseconds INSTRUCTION_TICK(10);
+
+std::chrono::steady_clock::time_point toTimePoint(int64_t rep) {
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(rep));
+}
+
+// 0 means "not idle"
+int ticksSince(int64_t since) {
+    if (since == 0) return 0;
+    return static_cast<int>((std::chrono::steady_clock::now() - toTimePoint(since)) / TICK_DURATION);
+}
+
+} // namespace
 
 FCFSScheduler::FCFSScheduler(int numCores)
-    : numCores(numCores), running(false), cpuCycles(0), activeTicks(0), idleTicks(0), processGenActive(false) {
+    : numCores(numCores), idleCores(numCores), runningSlots(new std::atomic<Process*>[numCores]), idleSince(new std::atomic<int64_t>[numCores]),
+      running(false), cpuCycles(0), activeTicks(0), idleTicks(0), processGenActive(false) {
+    for (int c = 0; c < numCores; ++c) {
+        runningSlots[c].store(nullptr);
+        idleSince[c].store(0);
+    }
+    cores.assign(numCores, CoreState());
+    finishedProcesses.setCapacity(static_cast<size_t>(archive_size));
     memoryManager = new MemoryManager(max_overall_mem, max_mem_per_proc, mem_per_frame);
 }
 
@@ -34,30 +69,69 @@ FCFSScheduler::~FCFSScheduler() {
 
 void FCFSScheduler::addProcess(Process* proc) {
     std::lock_guard<std::mutex> lock(queueMutex);
-    readyProcesses.push_back(proc);
+    proc->transition(ProcessState::Ready, currentTick());
+    proc->recordArrival(proc->getStateEnteredAt(ProcessState::Ready));
+    index.insert(proc);
+    logSink.registerProcess(static_cast<std::uint32_t>(proc->getPid()), proc->getName());
     readyQueue.push(proc);
-    cv.notify_all();
+    wakeCore(idleCores.findIdle());
 }
 
 void FCFSScheduler::start() {
+    clockStart = std::chrono::steady_clock::now() - INSTRUCTION_TICK * stoppedTick.load();
     running = true;
-    availableCores.clear();
-    for (int i = 0; i < numCores; ++i) {
-        availableCores.insert(i);
-    }
-    for (int i = 0; i < numCores; ++i) {
-        cpuThreads.emplace_back(&FCFSScheduler::cpuWorker, this, i);
+    idleCores.setAll();
+    metrics = SchedulerMetrics();
+    int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+    for (int c = 0; c < numCores; ++c) idleSince[c].store(now);
+
+    // M:N: simulated cores are multiplexed onto at most one host thread per hardware thread
+    int hosts = std::max(1, std::min<int>(std::thread::hardware_concurrency(), numCores));
+    coresPerHost = (numCores + hosts - 1) / hosts;
+    hosts = (numCores + coresPerHost - 1) / coresPerHost;
+    hostCvs.reset(new std::condition_variable[hosts]);
+    numHosts = hosts;
+    for (int h = 0; h < hosts; ++h) {
+        cpuThreads.emplace_back(&FCFSScheduler::hostWorker, this, h);
     }
 }
 
 void FCFSScheduler::stop() {
+    if (running) stoppedTick = currentTick();
     running = false;
-    cv.notify_all();
+    processGenActive = false;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (int h = 0; h < numHosts; ++h) hostCvs[h].notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(genMutex);
+        genCv.notify_all();
+    }
     for (auto& t : cpuThreads) {
         if (t.joinable()) t.join();
     }
     cpuThreads.clear();
     if (processGeneratorThread.joinable()) processGeneratorThread.join();
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    requeueCores();
+}
+
+// Puts the processes left on a core by stop() back at the head of the ready queue, in core order
+// Caller must hold queueMutex
+void FCFSScheduler::requeueCores() {
+    std::queue<Process*> requeued;
+    for (int c = 0; c < numCores; ++c) {
+        Process* proc = cores[c].proc;
+        if (!proc) continue;
+        proc->transition(ProcessState::Ready, currentTick());
+        requeued.push(proc);
+        releaseCore(c);
+    }
+    if (requeued.empty()) return;
+    for (; !readyQueue.empty(); readyQueue.pop()) requeued.push(readyQueue.front());
+    readyQueue.swap(requeued);
 }
 
 bool FCFSScheduler::isRunning() const {
@@ -65,202 +139,359 @@ bool FCFSScheduler::isRunning() const {
 }
 
 std::vector<Process*> FCFSScheduler::getRunningProcesses() {
+    std::vector<Process*> procs;
+    for (int c = 0; c < numCores; ++c) {
+        Process* proc = runningSlots[c].load(std::memory_order_acquire);
+        if (proc) procs.push_back(proc);
+    }
+    return procs;
+}
+
+bool FCFSScheduler::getFinishedProcesses(const ArchiveQuery& query, std::vector<ProcessSummary>& out) {
     std::lock_guard<std::mutex> lock(queueMutex);
-    return runningProcesses;
+    return finishedProcesses.select(query, out);
 }
 
-std::vector<Process*> FCFSScheduler::getFinishedProcesses() {
+size_t FCFSScheduler::getFinishedCount() {
     std::lock_guard<std::mutex> lock(queueMutex);
-    return finishedProcesses;
+    return finishedProcesses.size();
 }
 
-std::vector<Process*> FCFSScheduler::getReadyProcesses() {
+bool FCFSScheduler::findFinishedProcess(const std::string& name, ProcessSummary& out) {
+    IndexEntry entry;
+    if (!index.findByName(name, entry) || entry.archived < 0) return false;
     std::lock_guard<std::mutex> lock(queueMutex);
-    return readyProcesses;
+    // It may have been dropped from the archive since the lookup
+    if (!finishedProcesses.contains(static_cast<size_t>(entry.archived))) return false;
+    out = finishedProcesses[static_cast<size_t>(entry.archived)];
+    return true;
 }
 
-void FCFSScheduler::cpuWorker(int coreId) {
+Process* FCFSScheduler::findLiveProcess(const std::string& name) {
+    IndexEntry entry;
+    return index.findByName(name, entry) ? entry.live : nullptr;
+}
+
+bool FCFSScheduler::findNameByPid(int pid, std::string& name) {
+    ProcessReclaimer::Guard guard;
+    IndexEntry entry;
+    if (!index.findByPid(pid, entry)) return false;
+    if (entry.live) {
+        name = entry.live->getName();
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (entry.archived < 0 || !finishedProcesses.contains(static_cast<size_t>(entry.archived))) return false;
+    name = finishedProcesses[static_cast<size_t>(entry.archived)].name;
+    return true;
+}
+
+// One host thread steps a contiguous batch of simulated cores. Idle cores pick up work as soon as
+// it is queued; busy cores advance one instruction per INSTRUCTION_TICK,
+// ticks-per-step ticks at a time.
+void FCFSScheduler::hostWorker(int hostId) {
+    int first = hostId * coresPerHost;
+    int last = std::min(first + coresPerHost, numCores);
+    // Ticks each core advances per wakeup. Batch mode retires ALU ops between ticks, so it steps singly.
+    const int step = execution_mode == "batch" ? 1 : std::max(1, ticks_per_step);
+    auto nextTick = std::chrono::steady_clock::now() + INSTRUCTION_TICK * step;
+    BatchInterpreter batch; // this host's ALU ops for the current tick (execution-mode "batch")
+    std::unique_lock<std::mutex> lock(queueMutex);
+
     while (running) {
-        Process* proc = nullptr;
-        int assignedCore = -1;
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            cv.wait(lock, [this] { return (!readyQueue.empty() && !availableCores.empty()) || !running; });
-            if (!running) break;
-            if (!readyQueue.empty() && !availableCores.empty()) {
-                proc = readyQueue.front();
-                readyQueue.pop();
-                assignedCore = *availableCores.begin();
-                availableCores.erase(availableCores.begin());
-                if (std::find(runningProcesses.begin(), runningProcesses.end(), proc) == runningProcesses.end()) {
-                    runningProcesses.push_back(proc);
-                }
+        advanceTimers();
+        bool busy = false;
+        for (int c = first; c < last; ++c) {
+            if (!cores[c].proc) dispatchCore(c);
+            if (cores[c].proc) busy = true;
+        }
+
+        if (!busy) {
+            // Whole batch idle: park the host thread until work is queued.
+            // Host 0 also keeps the timer wheel turning, so it only parks until the next tick while anyone sleeps.
+            auto hasWork = [this] { return !readyQueue.empty() || !running; };
+            if (hostId == 0 && !timers.empty()) {
+                hostCvs[hostId].wait_until(lock, clockStart + INSTRUCTION_TICK * (timers.getCurrentTick() + 1), hasWork);
+            } else {
+                hostCvs[hostId].wait(lock, [this, hostId, &hasWork] { return hasWork() || (hostId == 0 && !timers.empty()); });
             }
+            nextTick = std::chrono::steady_clock::now() + INSTRUCTION_TICK * step;
+            continue;
         }
-        if (proc && assignedCore != -1 && proc->getStatus() == "Ready") {
-            proc->setCpuId(assignedCore);
-            int totalInstr = proc->getTotalLines();
-            int cur_instr = proc->getCurrentLine();
-            int numPages = static_cast<int>(std::ceil(static_cast<double>(proc->getMemSize()) / mem_per_frame));
-
-            while (proc->getCurrentLine() < proc->getTotalLines()) {
-                std::string victimProc = "";
-                int address = proc->getCurrentLine();
-                proc->setStatus("Running");
-                int pageNumber = (address / mem_per_frame) - 1;
-                if (pageNumber < 0) pageNumber = 0;
-
-                memoryManager->accessPage(proc->getName(), pageNumber);
-
-                if (delay_per_exec > 0) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(delay_per_exec));
-                }
 
-                proc->executeCurrentCommand(assignedCore, proc->getName(), "");
+        if (std::chrono::steady_clock::now() < nextTick) {
+            hostCvs[hostId].wait_until(lock, nextTick);
+            continue;
+        }
+        nextTick += INSTRUCTION_TICK * step;
 
-                //(to catch 100% or 0% cpu utilization)
-                std::this_thread::sleep_for(std::chrono::milliseconds(10)); 
+        lock.unlock();
+        for (int c = first; c < last; ++c) {
+            if (cores[c].proc) stepCore(c, batch, step);
+        }
+        if (!batch.empty()) batch.run();
+        lock.lock();
 
-                proc->moveCurrentLine();
-                cpuCycles++;
-                activeTicks++;
-            }
+        for (int c = first; c < last; ++c) {
+            if (!cores[c].proc) continue;
+            if (cores[c].proc->isFinished()) finishProcess(c);
+            else if (cores[c].sleepTicks > 0) sleepProcess(c);
+        }
+    }
+}
 
-            bool finished = proc->getCurrentLine() >= proc->getTotalLines();
+// Caller must hold queueMutex
+bool FCFSScheduler::dispatchCore(int core) {
+    if (readyQueue.empty()) return false;
+    Process* proc = readyQueue.front();
+    readyQueue.pop();
+    uint64_t tick = currentTick();
+    if (!proc->transition(ProcessState::Ready, ProcessState::Running, tick)) return false;
+    proc->recordDispatch(tick);
+
+    cores[core] = CoreState();
+    cores[core].proc = proc;
+    idleCores.claim(core);
+    runningSlots[core].store(proc, std::memory_order_release);
+    idleTicks += ticksSince(idleSince[core].exchange(0));
+    proc->setCpuId(core);
+    proc->startTask(memoryManager, page_fault_ticks);
+
+    if (!readyQueue.empty()) wakeCore(idleCores.findIdle(core));
+    return true;
+}
 
-            {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                if (finished) {
-                    proc->setEndTime(getCurrentTimestamp());
-                    proc->setStatus("Finished");
-                    finishedProcesses.push_back(proc);
-                    memoryManager->freeProcessMemory(proc->getName());
-                }
-                runningProcesses.erase(std::remove(runningProcesses.begin(), runningProcesses.end(), proc), runningProcesses.end());
-                availableCores.insert(assignedCore);
-                cv.notify_all();
-            }
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            cpuCycles++;
-            idleTicks++;
+// Advances one busy core by up to `ticks` ticks. Only the owning host thread touches cores[core].
+void FCFSScheduler::stepCore(int core, BatchInterpreter& batch, int ticks) {
+    CoreState& cs = cores[core];
+    Process* proc = cs.proc;
+    int used = 0;
+
+    while (used < ticks) {
+        int left = ticks - used;
+        if (cs.delayTicks > 0 || cs.waitTicks > 0) {
+            int& pending = cs.delayTicks > 0 ? cs.delayTicks : cs.waitTicks;
+            int n = std::min(pending, left);
+            pending -= n;
+            used += n;
+            continue;
+        }
+
+        // The page-in is over
+        if (proc->getState() == ProcessState::Blocked) proc->transition(ProcessState::Running, currentTick());
+        SliceResult slice = proc->executeSlice(left, left);
+        used += slice.ticks;
+        cs.delayTicks = slice.delayLeft;
+        if (slice.stop == SuspendReason::Alu) {
+            batch.add(proc);
+            break;
+        }
+        if (slice.stop == SuspendReason::Sleep) {
+            cs.sleepTicks = slice.waitTicks;
+            break;
         }
+        if (slice.stop == SuspendReason::PageIn) {
+            cs.waitTicks = slice.waitTicks;
+            proc->transition(ProcessState::Blocked, currentTick());
+        }
+        if (proc->isFinished() || slice.stop == SuspendReason::Finished) break;
+    }
+    cpuCycles += used;
+    activeTicks += used;
+}
+
+// Caller must hold queueMutex
+void FCFSScheduler::finishProcess(int core) {
+    Process* proc = cores[core].proc;
+    proc->setEndTime(Timestamp::now(currentTick()));
+    proc->transition(ProcessState::Finished, currentTick());
+    proc->recordCompletion(proc->getStateEnteredAt(ProcessState::Finished));
+    metrics.record(*proc);
+    ProcessSummary dropped;
+    if (finishedProcesses.append(ProcessSummary::of(*proc), dropped)) index.remove(dropped.name, dropped.pid);
+    index.archive(proc, finishedProcesses.size() - 1);
+    logSink.closeProcess(static_cast<std::uint32_t>(proc->getPid()));
+    memoryManager->freeProcessMemory(proc->getName());
+    releaseCore(core);
+    // Unreachable now except through guards the console already holds
+    processReclaimer.retire(proc);
+}
+
+// Takes a sleeping process off its core; it rejoins the back of the ready queue when its timer fires
+// Caller must hold queueMutex
+void FCFSScheduler::sleepProcess(int core) {
+    Process* proc = cores[core].proc;
+    proc->transition(ProcessState::Sleeping, currentTick());
+    proc->setWakeTick(currentTick() + cores[core].sleepTicks);
+    timers.schedule(proc, proc->getWakeTick());
+    hostCvs[0].notify_one();
+    releaseCore(core);
+}
+
+// Caller must hold queueMutex
+void FCFSScheduler::releaseCore(int core) {
+    cores[core].proc = nullptr;
+    runningSlots[core].store(nullptr, std::memory_order_release);
+    idleSince[core].store(std::chrono::steady_clock::now().time_since_epoch().count());
+    idleCores.release(core);
+}
+
+uint64_t FCFSScheduler::currentTick() const {
+    if (!running) return stoppedTick.load();
+    return static_cast<uint64_t>((std::chrono::steady_clock::now() - clockStart) / INSTRUCTION_TICK);
+}
+
+// Caller must hold queueMutex
+void FCFSScheduler::advanceTimers() {
+    if (timers.empty()) return;
+    std::vector<Process*> expired;
+    timers.advance(currentTick(), expired);
+    for (Process* proc : expired) {
+        proc->transition(ProcessState::Ready, currentTick());
+        readyQueue.push(proc);
     }
+    if (!expired.empty()) wakeCore(idleCores.findIdle());
+}
+
+SchedulerMetrics FCFSScheduler::getMetrics() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return metrics;
+}
+
+std::vector<std::pair<Process*, int>> FCFSScheduler::getSleepingProcesses() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    std::vector<std::pair<Process*, int>> sleeping;
+    uint64_t now = currentTick();
+    for (const auto& [proc, expiry] : timers.entries()) {
+        sleeping.emplace_back(proc, expiry > now ? static_cast<int>(expiry - now) : 0);
+    }
+    return sleeping;
+}
+
+// Caller must hold queueMutex
+void FCFSScheduler::wakeCore(int core) {
+    if (core >= 0) hostCvs[hostOf(core)].notify_one();
 }
 
 float FCFSScheduler::getCpuUtilization() {
     int totalCores = numCores;
-    int busyCores = 0;
-    {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        if (!running) {
-            busyCores = 0;
-        } else {
-            busyCores = totalCores - static_cast<int>(availableCores.size());
-        }
-    }
+    int busyCores = running ? totalCores - idleCores.count() : 0;
     if (totalCores == 0) return 0.0f;
     float cpuUtilization = (static_cast<float>(busyCores) * 100.0f) / totalCores;
     return cpuUtilization;
 }
 
 int FCFSScheduler::getBusyCores() {
-    std::lock_guard<std::mutex> lock(queueMutex);
     if (!running) return 0;
-    return numCores - static_cast<int>(availableCores.size());
+    return numCores - idleCores.count();
 }
 
 void FCFSScheduler::startProcessGenerator(int batchFreq) {
     batchProcessFreq = batchFreq;
     processGenActive = true;
+    generationPool.start(generator_threads);
     processGeneratorThread = std::thread(&FCFSScheduler::processGeneratorFunc, this);
 }
 
 void FCFSScheduler::stopProcessGenerator() {
     processGenActive = false;
+    {
+        std::lock_guard<std::mutex> lock(genMutex);
+        genCv.notify_all();
+    }
     if (processGeneratorThread.joinable()) processGeneratorThread.join();
+    generationPool.stop();
 }
 
 uint32_t FCFSScheduler::getCpuCycles() {
     return cpuCycles.load();
 }
 
-std::string FCFSScheduler::getCurrentTimestamp() {
-    std::time_t now = std::time(nullptr);
-    std::tm localTime;
-#ifdef _WIN32
-    localtime_s(&localTime, &now);
-#else
-    localtime_r(&now, &localTime);
-#endif
-    std::ostringstream oss;
-    oss << std::put_time(&localTime, "%m/%d/%Y, %I:%M:%S %p");
-    return oss.str();
-}
-
 void FCFSScheduler::processGeneratorFunc() {
-    uint32_t lastCycle = -1;
     while (processGenActive && running) {
-        uint32_t cycle = getCpuCycles();
-        if (batchProcessFreq > 0 && cycle % batchProcessFreq == 0 && lastCycle != cycle) {
-            int min_exp = static_cast<int>(std::log2(min_mem_per_proc));
-            int max_exp = static_cast<int>(std::log2(max_mem_per_proc));
-            int chosen_exp = min_exp + (std::rand() % (max_exp - min_exp + 1));
-            int mem_for_proc = 1 << chosen_exp;
-
-            int numPages = static_cast<int>(std::ceil(static_cast<double>(mem_for_proc) / mem_per_frame));
-            int totalFrames = static_cast<int>(std::ceil(static_cast<double>(max_overall_mem) / mem_per_frame));
-            int usedFrames = 0;
-            {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                for (const auto& pt : memoryManager->getPageTables()) {
-                    for (const auto& entry : pt.second) {
-                        if (entry.valid) ++usedFrames;
-                    }
+        {
+            // Sleep until the next batch is due instead of polling every tick
+            std::unique_lock<std::mutex> lock(genMutex);
+            auto stopping = [this] { return !processGenActive || !running; };
+            if (batchProcessFreq > 0) {
+                genCv.wait_for(lock, TICK_DURATION * batchProcessFreq, stopping);
+            } else {
+                genCv.wait(lock, stopping);
+            }
+        }
+        if (!processGenActive || !running) break;
+
+        // Admission is decided serially in pid order; each pid's numbers come from its own
+        // (seed, pid) stream, so the same config seed spawns the same processes
+        int min_exp = static_cast<int>(std::log2(min_mem_per_proc));
+        int max_exp = static_cast<int>(std::log2(max_mem_per_proc));
+        int totalFrames = static_cast<int>(std::ceil(static_cast<double>(max_overall_mem) / mem_per_frame));
+        int usedFrames = 0;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            for (const auto& pt : memoryManager->getPageTables()) {
+                for (const auto& entry : pt.second) {
+                    if (entry.valid) ++usedFrames;
                 }
             }
+        }
+
+        struct Spawn {
+            Process* process;
+            int totalInstructions;
+            std::uint64_t programSeed;
+        };
+        std::vector<Spawn> batch;
+        Timestamp timestamp = Timestamp::now(currentTick());
+        for (int i = 0; i < std::max(1, batch_process_size); ++i) {
+            SplitMix64 stream(SplitMix64::streamSeed(random_seed, static_cast<std::uint64_t>(curr_id)));
+            // Only allow mem_for_proc to be a power of 2 between min and max (inclusive)
+            int mem_for_proc = 1 << stream.range(min_exp, max_exp);
+            int numPages = static_cast<int>(std::ceil(static_cast<double>(mem_for_proc) / mem_per_frame));
+            if (usedFrames + numPages > totalFrames) break;
+            usedFrames += numPages;
 
-            int totalInstructions = min_ins + (std::rand() % (max_ins - min_ins + 1));
+            int totalInstructions = stream.range(min_ins, max_ins);
             std::string processName = "auto_proc_" + std::to_string(curr_id);
-            std::string timestamp = getCurrentTimestamp();
-            Process* newProcess = new Process(curr_id, processName, 0, totalInstructions, timestamp, "Ready", mem_for_proc);
-
-            if (usedFrames + numPages <= totalFrames) {
-                curr_id++;
-                newProcess->createPrintCommands(totalInstructions);
-
-                // Optionally, calculate totalInstrBytes and terminate if needed (see RR logic)
-                /*
-                int totalInstrBytes = 0;
-                for (const std::string& cmd : newProcess->getAllInstructions()) {
-                    totalInstrBytes += getInstructionSize(cmd);
-                }
-                if (totalInstrBytes > mem_for_proc) {
-                    newProcess->setStatus("Terminated (Insufficient Memory)");
-                    newProcess->setEndTime(getCurrentTimestamp());
-                    finishedProcesses.push_back(newProcess);
-                    continue;
-                }
-                */
+            Process* newProcess = new Process(curr_id, processName, 0, totalInstructions, timestamp, mem_for_proc);
+            batch.push_back({ newProcess, totalInstructions, stream.next() });
+            curr_id++;
+        }
 
-                addProcess(newProcess);
-                lastCycle = cycle;
+        // Programs are independent, so they are built across the pool
+        generationPool.parallelFor(static_cast<int>(batch.size()), [&batch](int i) {
+            const Spawn& spawn = batch[i];
+            if (program_generation == "lazy") {
+                spawn.process->createLazyProgram(spawn.totalInstructions, spawn.programSeed);
+            } else {
+                spawn.process->createPrintCommands(spawn.totalInstructions, spawn.programSeed);
             }
+        });
+
+        for (const Spawn& spawn : batch) {
+            addProcess(spawn.process);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        cpuCycles++;
-        idleTicks++;
     }
 }
 
 int FCFSScheduler::getAvailableCores() {
-    std::lock_guard<std::mutex> lock(queueMutex);
     if (!running) return numCores;
-    return static_cast<int>(availableCores.size());
+    return idleCores.count();
+}
+
+// Finished idle periods plus the time cores have been parked so far
+int FCFSScheduler::getIdleTicks() const {
+    int total = idleTicks.load();
+    for (int c = 0; c < numCores; ++c) {
+        total += ticksSince(idleSince[c].load());
+    }
+    return total;
 }
 
 void FCFSScheduler::printVMStat(){
-    memoryManager->printVMStat(cpuCycles.load(), idleTicks.load(), activeTicks.load());
+    int idle = getIdleTicks();
+    int active = activeTicks.load();
+    memoryManager->printVMStat(idle + active, idle, active);
 }
 
 void FCFSScheduler::printProcessSMI(){
@@ -279,7 +510,8 @@ void FCFSScheduler::printProcessSMI(){
     oss << "\n===========================================\n";
     oss << "Running processes and memory usage:\n";
     oss << "-------------------------------------------\n";
-    for(auto& proc : runningProcesses) {
+    ProcessReclaimer::Guard guard;
+    for(auto* proc : getRunningProcesses()) {
         std::string startAddr = "0x0040";
         int memUsage = memoryManager->getProcessMemoryUsage(proc->getName());
         oss << proc->getName() << " (" << memUsage << "KiB) \n";
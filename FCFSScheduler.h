@@ -5,7 +5,16 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <set>
+#include "CoreMask.h"
+#include "TimerWheel.h"
+#include "WorkerPool.h"
+#include "BatchInterpreter.h"
+#include "LatencyHistogram.h"
+#include "ProcessArchive.h"
+#include "ProcessReclaimer.h"
+#include "ProcessIndex.h"
 #include "Process.h"
 #include "MemoryManager.h"
 
@@ -19,36 +28,71 @@ public:
     void stop();
     bool isRunning() const;
     std::vector<Process*> getRunningProcesses();
-    std::vector<Process*> getFinishedProcesses();
-    std::vector<Process*> getReadyProcesses();
+    // One page of the finished processes' summaries, in completion order (see ArchiveQuery);
+    // returns whether older matches remain
+    bool getFinishedProcesses(const ArchiveQuery& query, std::vector<ProcessSummary>& out);
+    size_t getFinishedCount();
+    bool findFinishedProcess(const std::string& name, ProcessSummary& out);
+    // Admitted, unfinished process with this name; the caller must hold a ProcessReclaimer::Guard
+    Process* findLiveProcess(const std::string& name);
+    // Name of the live or archived process with this pid
+    bool findNameByPid(int pid, std::string& name);
     void startProcessGenerator(int batchFreq);
     void stopProcessGenerator();
     uint32_t getCpuCycles();
     void printVMStat();
     void printProcessSMI();
     int getActiveTicks() const { return activeTicks.load(); }
-    int getIdleTicks() const { return idleTicks.load(); }
+    int getIdleTicks() const;
     float getCpuUtilization();
     int getBusyCores();
     int getAvailableCores();
+    // Processes blocked in SLEEP, with the ticks left before they are requeued
+    std::vector<std::pair<Process*, int>> getSleepingProcesses();
+    // Latency distributions of the processes finished since start()
+    SchedulerMetrics getMetrics();
+    // Ticks the scheduler has run for, paused between stop() and start(): INSTRUCTION_TICK each
+    uint64_t currentTick() const;
 
 private:
     void schedulerThreadFunc();
-    void cpuWorker(int coreId);
+    void hostWorker(int hostId);
+    bool dispatchCore(int core);
+    void stepCore(int core, BatchInterpreter& batch, int ticks);
+    void finishProcess(int core);
+    void sleepProcess(int core);
+    void releaseCore(int core);
+    void requeueCores();
+    void advanceTimers();
+    int hostOf(int core) const { return core / coresPerHost; }
     void processGeneratorFunc();
-    std::string getCurrentTimestamp();
+    void wakeCore(int core);
 
     int numCores;
-    std::vector<std::thread> cpuThreads;
+    std::vector<std::thread> cpuThreads; // host worker pool
     std::thread schedulerThread;
     std::queue<Process*> readyQueue;
-    std::vector<Process*> runningProcesses;
-    std::vector<Process*> finishedProcesses;
-    std::vector<Process*> readyProcesses;
+    CoreMask idleCores; // bit set = core idle
+    std::unique_ptr<std::atomic<Process*>[]> runningSlots; // process on each core, nullptr when idle
+    ProcessArchive finishedProcesses; // guarded by queueMutex
+    ProcessIndex index; // every admitted process by name and pid, live or archived
     std::mutex queueMutex;
-    std::condition_variable cv;
+    std::unique_ptr<std::atomic<int64_t>[]> idleSince; // steady_clock ticks when the core went idle, 0 while busy
+
+    // Simulated core state machine, stepped by the host thread that owns the core
+    struct CoreState {
+        Process* proc = nullptr;
+        int delayTicks = 0;   // delay-per-exec busy-wait left
+        int waitTicks = 0;    // page-in the process is blocked on
+        int sleepTicks = 0;   // SLEEP: leave the core and wait on the timer wheel
+    };
+    std::vector<CoreState> cores;
+    int coresPerHost = 1;
+    int numHosts = 0;
+    std::unique_ptr<std::condition_variable[]> hostCvs; // idle host threads park here (with queueMutex)
+    std::mutex genMutex;
+    std::condition_variable genCv;
     std::atomic<bool> running;
-    std::set<int> availableCores;
     MemoryManager* memoryManager;
     std::atomic<uint32_t> cpuCycles{0};
     std::atomic<int> activeTicks{0};
@@ -56,4 +100,11 @@ private:
     std::atomic<bool> processGenActive{false};
     std::thread processGeneratorThread;
     int batchProcessFreq = 0;
+    WorkerPool generationPool; // builds each batch's programs in parallel
+
+    // Sleeping processes, keyed on currentTick(); kept across stop/start (guarded by queueMutex)
+    TimerWheel timers;
+    SchedulerMetrics metrics; // guarded by queueMutex
+    std::chrono::steady_clock::time_point clockStart; // when tick 0 would have been, had the scheduler never stopped
+    std::atomic<uint64_t> stoppedTick{0}; // currentTick() at the last stop(): held while stopped, resumed by start()
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "LatencyHistogram.h"
+#include "Process.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+int LatencyHistogram::bucketOf(std::uint64_t value) {
+    if (value < 2 * SUB_COUNT) return static_cast<int>(value);
+    int shift = std::bit_width(value) - 1 - SUB_BITS; // value >> shift lands in [32, 64)
+    return 2 * SUB_COUNT + (shift - 1) * SUB_COUNT + static_cast<int>((value >> shift) - SUB_COUNT);
+}
+
+std::uint64_t LatencyHistogram::highestIn(int bucket) {
+    if (bucket < 2 * SUB_COUNT) return static_cast<std::uint64_t>(bucket);
+    int shift = (bucket - 2 * SUB_COUNT) / SUB_COUNT + 1;
+    std::uint64_t sub = static_cast<std::uint64_t>((bucket - 2 * SUB_COUNT) % SUB_COUNT + SUB_COUNT);
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t value) {
+    counts[bucketOf(value)]++;
+    total++;
+    sum += value;
+    maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+    total += other.total;
+    sum += other.sum;
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * total));
+    if (rank == 0) rank = 1;
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(highestIn(i), maxValue);
+    }
+    return maxValue;
+}
+
+// The tick clock restarts with the scheduler, so a process queued before a restart can look older
+static std::uint64_t ticksBetween(std::uint64_t from, std::uint64_t to) {
+    return to > from ? to - from : 0;
+}
+
+void SchedulerMetrics::record(const Process& proc) {
+    const ScheduleTimes& t = proc.getScheduleTimes();
+    response.record(ticksBetween(t.arrival, t.firstDispatch));
+    waiting.record(t.waiting);
+    turnaround.record(ticksBetween(t.arrival, t.completion));
+    dispatches.record(static_cast<std::uint64_t>(t.dispatches));
+}
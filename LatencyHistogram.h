@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class Process;
+
+// HDR-style histogram of non-negative integer samples (ticks, counts). Values below 64 are exact;
+// above that each power of two is split into 32 buckets, so any reported value is within ~3%.
+class LatencyHistogram {
+public:
+    LatencyHistogram() : counts(BUCKETS, 0) {}
+
+    void record(std::uint64_t value);
+    void merge(const LatencyHistogram& other);
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return maxValue; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+    // Value at or below which p percent of the samples fall (p in 0..100)
+    std::uint64_t percentile(double p) const;
+
+private:
+    static const int SUB_BITS = 5;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int BUCKETS = 2 * SUB_COUNT + (64 - SUB_BITS - 1) * SUB_COUNT;
+
+    static int bucketOf(std::uint64_t value);
+    static std::uint64_t highestIn(int bucket);
+
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t maxValue = 0;
+};
+
+// Per-scheduler distributions over finished processes, in scheduler ticks
+struct SchedulerMetrics {
+    LatencyHistogram response;   // arrival to first dispatch
+    LatencyHistogram waiting;    // total time spent Ready
+    LatencyHistogram turnaround; // arrival to completion
+    LatencyHistogram dispatches; // times put on a core (context switches in)
+
+    void record(const Process& proc);
+};
@@ -0,0 +1,185 @@
+#include "LogSink.h"
+#include "Timestamp.h"
+#include <chrono>
+
+LogSink logSink;
+
+const char* const LogSink::COMBINED_FILE = "csopesy-print-log.txt";
+
+// How long the flusher sleeps when the ring is empty
+static const std::chrono::milliseconds FLUSH_INTERVAL(20);
+
+void LogSink::start(Output out, FullPolicy full, std::size_t capacity) {
+    stop();
+    output = out;
+    policy = full;
+    if (output == Output::None) return;
+
+    std::size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots.reset(new Slot[size]);
+    for (std::size_t i = 0; i < size; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    mask = size - 1;
+    head.store(0);
+    tail = 0;
+
+    if (output == Output::Combined) combined.open(COMBINED_FILE, std::ios::trunc);
+    running = true;
+    flusher = std::thread(&LogSink::flusherFunc, this);
+}
+
+void LogSink::stop() {
+    running = false;
+    if (flusher.joinable()) flusher.join();
+    if (combined.is_open()) combined.close();
+}
+
+void LogSink::push(const LogRecord& record) {
+    if (!running.load(std::memory_order_relaxed)) return;
+    while (!tryPush(record)) {
+        // A close is never dropped, or the process's name would stay registered for good
+        if ((policy == FullPolicy::Drop && !record.close) || !running.load(std::memory_order_relaxed)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void LogSink::registerProcess(std::uint32_t pid, const std::string& name) {
+    if (!running.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(formatsMutex);
+    names[pid] = name;
+}
+
+void LogSink::closeProcess(std::uint32_t pid) {
+    LogRecord record;
+    record.pid = pid;
+    record.close = true;
+    push(record);
+}
+
+std::uint32_t LogSink::formatId(const std::string& text) {
+    std::lock_guard<std::mutex> lock(formatsMutex);
+    auto it = formatIndex.find(text);
+    if (it != formatIndex.end()) return it->second;
+    std::uint32_t id = static_cast<std::uint32_t>(formats.size());
+    formats.push_back(text);
+    formatIndex.emplace(text, id);
+    return id;
+}
+
+std::string LogSink::format(const LogRecord& record) {
+    std::string line;
+    appendTime(line, record.time, TimeFormat::Log);
+    line += "    Core:" + std::to_string(record.core) + "    ";
+    std::lock_guard<std::mutex> lock(formatsMutex);
+    appendMessage(line, record);
+    return line;
+}
+
+void LogSink::appendMessage(std::string& out, const LogRecord& record) {
+    out += formats[record.format];
+    if (record.hasValue) out += std::to_string(record.value);
+}
+
+// Bounded MPSC queue (Vyukov's ring, one consumer): each slot's sequence says whose turn it is
+bool LogSink::tryPush(const LogRecord& record) {
+    std::uint64_t pos = head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[pos & mask];
+        std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::int64_t diff = static_cast<std::int64_t>(sequence) - static_cast<std::int64_t>(pos);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+    slot->record = record;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogSink::tryPop(LogRecord& record) {
+    Slot& slot = slots[tail & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+    record = slot.record;
+    slot.sequence.store(tail + mask + 1, std::memory_order_release);
+    ++tail;
+    return true;
+}
+
+// Drains the ring in batches; after stop() it keeps going until the ring is empty
+void LogSink::flusherFunc() {
+    std::vector<LogRecord> batch;
+    batch.reserve(mask + 1);
+    for (;;) {
+        batch.clear();
+        LogRecord record;
+        while (batch.size() <= mask && tryPop(record)) batch.push_back(record);
+        if (!batch.empty()) {
+            write(batch);
+            continue;
+        }
+        if (!running) break;
+        std::this_thread::sleep_for(FLUSH_INTERVAL);
+    }
+}
+
+// One write per file per batch: the combined log, or each process's <name>.txt
+void LogSink::write(const std::vector<LogRecord>& batch) {
+    std::unordered_map<std::uint32_t, std::string> perProcess;
+    std::string all;
+    std::unordered_set<std::uint32_t> closed;
+    {
+        std::lock_guard<std::mutex> lock(formatsMutex);
+        for (const LogRecord& record : batch) {
+            if (record.close) {
+                closed.insert(record.pid);
+                continue;
+            }
+            std::string& out = output == Output::Combined ? all : perProcess[record.pid];
+            if (output == Output::Combined) {
+                auto name = names.find(record.pid);
+                out += name != names.end() ? name->second : std::to_string(record.pid);
+                out += "    ";
+            }
+            appendTime(out, record.time, TimeFormat::Log);
+            out += "    Core:";
+            out += std::to_string(record.core);
+            out += "    ";
+            appendMessage(out, record);
+            out += '\n';
+        }
+    }
+
+    if (output == Output::Combined) {
+        combined << all;
+        combined.flush();
+    } else {
+        for (const auto& [pid, text] : perProcess) {
+            std::string name;
+            {
+                std::lock_guard<std::mutex> lock(formatsMutex);
+                auto it = names.find(pid);
+                name = it != names.end() ? it->second : std::to_string(pid);
+            }
+            // A process's first write this run starts its file over
+            bool first = opened.insert(pid).second;
+            std::ofstream file(name + ".txt", first ? std::ios::trunc : std::ios::app);
+            file << text;
+        }
+    }
+
+    if (!closed.empty()) {
+        std::lock_guard<std::mutex> lock(formatsMutex);
+        for (std::uint32_t pid : closed) {
+            names.erase(pid);
+            opened.erase(pid);
+        }
+    }
+}
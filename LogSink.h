@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// One PRINT as a core logs it: ids and numbers only, formatted later by whoever reads it
+struct LogRecord {
+    std::int64_t time = 0;     // steadyNanos() when it ran
+    std::uint32_t pid = 0;
+    std::uint32_t format = 0;  // LogSink::formatId of the message
+    std::int16_t core = -1;
+    std::uint16_t value = 0;   // the PRINT's variable, appended when hasValue is set
+    bool hasValue = false;
+    bool close = false;        // not a PRINT: the process is gone, flush and forget it
+};
+
+// PRINT output of every process. Cores push records into a bounded lock-free MPSC ring; a
+// background thread formats them and appends them to the log files in large writes.
+class LogSink {
+public:
+    enum class Output { None, Combined, PerProcess };
+    enum class FullPolicy { Drop, Block };
+
+    static const char* const COMBINED_FILE;
+
+    ~LogSink() { stop(); }
+
+    void start(Output output, FullPolicy policy, std::size_t capacity);
+    // Writes out everything already pushed, then stops the flusher
+    void stop();
+
+    // Producers, from any thread. No-ops unless started with an output.
+    void push(const LogRecord& record);
+    void registerProcess(std::uint32_t pid, const std::string& name);
+    void closeProcess(std::uint32_t pid);
+
+    // Interned message text; ids stay valid for the life of the emulator
+    std::uint32_t formatId(const std::string& text);
+    // "(time)    Core:c    message", as process-smi shows it
+    std::string format(const LogRecord& record);
+    std::uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        LogRecord record;
+    };
+
+    bool tryPush(const LogRecord& record);
+    bool tryPop(LogRecord& record); // flusher only
+    void flusherFunc();
+    void write(const std::vector<LogRecord>& batch);
+    void appendMessage(std::string& out, const LogRecord& record); // caller holds formatsMutex
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask = 0;
+    std::atomic<std::uint64_t> head{0}; // next position producers claim
+    std::uint64_t tail = 0;             // next position the flusher reads
+    std::atomic<bool> running{false};
+    std::atomic<std::uint64_t> dropped{0};
+    Output output = Output::None;
+    FullPolicy policy = FullPolicy::Drop;
+    std::thread flusher;
+    std::ofstream combined;
+
+    std::mutex formatsMutex;
+    std::vector<std::string> formats;
+    std::unordered_map<std::string, std::uint32_t> formatIndex;
+    std::unordered_map<std::uint32_t, std::string> names; // live processes, for file names and the combined log
+
+    // Flusher only: processes whose per-process file was started this run
+    std::unordered_set<std::uint32_t> opened;
+};
+
+extern LogSink logSink;
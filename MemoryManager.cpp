@@ -7,6 +7,7 @@
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <climits>
 
 MemoryManager::MemoryManager(int totalMem, int memPerProc, int memPerFrame)
     : totalMem(totalMem), memPerProc(memPerProc), memPerFrame(memPerFrame), pagesPagedIn(0), pagesPagedOut(0) {
@@ -58,15 +59,17 @@ void MemoryManager::freeProcessMemory(const std::string& procName) {
     }
 }
 
-std::string MemoryManager::accessPage(const std::string& procName, int pageNumber) {
+std::string MemoryManager::accessPage(const std::string& procName, int pageNumber, bool* pageFault) {
     // If page is not in memory, handle page fault
     std::shared_lock<std::shared_mutex> lock(memoryMutex);
     std::string victimProc = "";
+    if (pageFault) *pageFault = false;
 
     if (pageTables[procName].size() <= pageNumber || !pageTables[procName][pageNumber].valid) {
         lock.unlock();
         //std::cout << "[Page Fault] Process: " << procName << ", Page: " << pageNumber << std::endl;
         victimProc = handlePageFault(procName, pageNumber);
+        if (pageFault) *pageFault = true;
     }
     return victimProc;
 }
@@ -83,6 +86,7 @@ std::string MemoryManager::handlePageFault(const std::string& procName, int page
         if (victim.occupied) {
             evictPageToBackingStore(victim.processName, victim.pageNumber, freeFrame);
             pageTables[victim.processName][victim.pageNumber].valid = false;
+            evictionEpoch.fetch_add(1, std::memory_order_release);
             victimProc = victim.processName;
         }
     }
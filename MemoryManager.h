@@ -4,6 +4,7 @@
 #include <string>
 #include <cstdint>
 #include <shared_mutex>
+#include <atomic>
 
 // --- Page Table Entry ---
 struct PageTableEntry {
@@ -29,7 +30,7 @@ public:
     MemoryManager(int totalMem, int memPerProc, int memPerFrame);
 
     // Core process memory management
-    std::string accessPage(const std::string& procName, int pageNumber);
+    std::string accessPage(const std::string& procName, int pageNumber, bool* pageFault = nullptr);
     std::string handlePageFault(const std::string& procName, int pageNumber);
     void freeProcessMemory(const std::string& procName);
 
@@ -45,6 +46,8 @@ public:
     void loadPageFromBackingStore(const std::string& procName, int pageNumber, int frameNumber);
     void evictPageToBackingStore(const std::string& procName, int pageNumber, int frameNumber);
     int getUsedMemory() const;
+    // Bumped whenever a resident page is evicted; while it is unchanged, resident pages stay resident
+    std::uint64_t getEvictionEpoch() const { return evictionEpoch.load(std::memory_order_acquire); }
     int getProcessMemoryUsage(const std::string& procName) const;
     
     // Frame management
@@ -67,6 +70,7 @@ private:
     int pagesPagedIn;
     int pagesPagedOut;
     int currentTick = 0;
+    std::atomic<std::uint64_t> evictionEpoch{0};
 
     std::vector<Frame> frames;
     std::unordered_map<std::string, std::vector<PageTableEntry>> pageTables;
@@ -1,339 +1,203 @@
 #include "Process.h"
-#include "PrintCommand.h"
+#include "MemoryManager.h"
 #include <iostream>
-#include <random>
-#include <ctime>
 #include <regex>
 #include <algorithm>
 #include <cctype>
 
-static std::mt19937 rng;
+extern int mem_per_frame;
+extern std::string program_optimization;
+extern std::string execution_mode;
+extern int delay_per_exec;
+
+// Runs the configured optimization pass over a freshly built program
+static void finishProgram(Program& program) {
+    if (program_optimization == "peephole") program.optimize();
+    program.bindLogFormats();
+}
+
+// Top-level instructions generated at a time in lazy mode
+static const int GENERATION_CHUNK = 64;
 static const uint16_t INVALID_VAL = 0xFFFF;
 
-Process::Process(int pid, const std::string& name, int currentLine, int totalLines, const std::string& timestamp, const std::string& status, int memSize)
-    : pid(pid), name(name), currentLine(currentLine), totalLines(totalLines), timestamp(timestamp), status(status), memSize(memSize) {
+Process::Process(int pid, const std::string& name, int currentLine, int totalLines, Timestamp created, int memSize)
+    : pid(pid), name(name), currentLine(currentLine), totalLines(totalLines), created(created), memSize(memSize) {
     this->cpuId = -1;
-    // Initialize all 32 variables
-    for (int i = 1; i <= 32; ++i) {
-        std::string var = "var" + std::to_string(i);
-        variables[i] = {0, var, false};
-    }
 }
 
 Process::Process(int pid, std::string processName, int memSize)
-    : pid(pid), name(processName), currentLine(0), totalLines(0), timestamp(""), status(""), cpuId(-1), startTime(0), memSize(memSize) {
-    // Initialize all 32 variables
-    for (int i = 1; i <= 32; ++i) {
-        std::string var = "var" + std::to_string(i);
-        variables[i] = {0, var, false};
-    }
+    : pid(pid), name(processName), currentLine(0), totalLines(0), cpuId(-1), memSize(memSize) {
 }
 
 Process::Process() 
-    : pid(0), name(""), currentLine(0), totalLines(0), timestamp(""), status(""), cpuId(-1), startTime(0), memSize(0) {
-    // Initialize all 32 variables
-    for (int i = 1; i <= 32; ++i) {
-        std::string var = "var" + std::to_string(i);
-        variables[i] = {0, var, false};
-    }
+    : pid(0), name(""), currentLine(0), totalLines(0), cpuId(-1), memSize(0) {
 }
 
-Process::Process(int pid, const std::string& name, int currentLine, const std::string& timestamp, const std::string& status, int memSize, std::vector<std::vector<std::string>> commandS){
+Process::Process(int pid, const std::string& name, int currentLine, Timestamp created, int memSize, std::vector<std::vector<std::string>> commandS){
     this->pid = pid;
     this->name = name;
     this->currentLine = currentLine;
-    this->timestamp = timestamp;
-    this->status = status;
+    this->created = created;
     this->memSize = memSize;
     this->cpuId = -1;
-    this->startTime = std::time(nullptr);
-    this->endTime = "";
-
-    // Initialize all 32 variables
-    for (int i = 1; i <= 32; ++i) {
-        std::string var = "var" + std::to_string(i);
-        variables[i] = {0, var, false};
-    }
-
-    totalLines = commandS.size();
-    commandOfStrings = commandS;
-    int x = 0;
-
-    for (size_t i = 0; i < commandOfStrings.size(); ++i) {
-        std::vector<std::string>& cmd = commandOfStrings[i];
-        const std::string& opcode = cmd[0];
-
-        if (cmd.size() == 2 && cmd[0] == "SLEEP" && isVal(cmd[1])) {
-            // n/a
-        }
-        else if (cmd.size() == 3 && cmd[0] == "DECLARE" && isVar(cmd[1]) && isVal(cmd[2])) {
-            uint16_t decVal = static_cast<uint16_t>(std::stoi(cmd[2]));
-            commands.push_back(new PrintCommand(1, cmd[1], decVal, "", INVALID_VAL, INVALID_VAL, "", "", "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 3 && cmd[0] == "WRITE" && isMemAdd(cmd[1]) && isVar(cmd[2])) {
-            commands.push_back(new PrintCommand(2, "", INVALID_VAL, "", INVALID_VAL, INVALID_VAL, "", "", cmd[1], cmd[2], INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 3 && cmd[0] == "READ" && isVar(cmd[1]) && isMemAdd(cmd[2])) {
-            commands.push_back(new PrintCommand(3, "", INVALID_VAL, "", INVALID_VAL, INVALID_VAL, "", "", "", "", INVALID_VAL, cmd[1], cmd[2], "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "ADD" && isVar(cmd[1]) && isVar(cmd[2]) && isVar(cmd[3])) {
-            commands.push_back(new PrintCommand(4, "", INVALID_VAL, cmd[1], INVALID_VAL, INVALID_VAL, cmd[2], cmd[3], "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "ADD" && isVar(cmd[1]) && isVar(cmd[2]) && isVal(cmd[3])) {
-            uint16_t val2 = static_cast<uint16_t>(std::stoi(cmd[3]));
-            commands.push_back(new PrintCommand(4, "", INVALID_VAL, cmd[1], INVALID_VAL, val2, cmd[2], "", "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "ADD" && isVar(cmd[1]) && isVal(cmd[2]) && isVar(cmd[3])) {
-            uint16_t val1 = static_cast<uint16_t>(std::stoi(cmd[2]));
-            commands.push_back(new PrintCommand(4, "", INVALID_VAL, cmd[1], val1, INVALID_VAL, "", cmd[3], "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "ADD" && isVar(cmd[1]) && isVal(cmd[2]) && isVal(cmd[3])) {
-            uint16_t val1 = static_cast<uint16_t>(std::stoi(cmd[2]));
-            uint16_t val2 = static_cast<uint16_t>(std::stoi(cmd[3]));
-            commands.push_back(new PrintCommand(4, "", INVALID_VAL, cmd[1], val1, val2, "", "", "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "SUB" && isVar(cmd[1]) && isVar(cmd[2]) && isVar(cmd[3])) {
-            commands.push_back(new PrintCommand(5, "", INVALID_VAL, cmd[1], INVALID_VAL, INVALID_VAL, cmd[2], cmd[3], "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "SUB" && isVar(cmd[1]) && isVar(cmd[2]) && isVal(cmd[3])) {
-            uint16_t val2 = static_cast<uint16_t>(std::stoi(cmd[3]));
-            commands.push_back(new PrintCommand(5, "", INVALID_VAL, cmd[1], INVALID_VAL, val2, cmd[2], "", "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "SUB" && isVar(cmd[1]) && isVal(cmd[2]) && isVar(cmd[3])) {
-            uint16_t val1 = static_cast<uint16_t>(std::stoi(cmd[2]));
-            commands.push_back(new PrintCommand(5, "", INVALID_VAL, cmd[1], val1, INVALID_VAL, "", cmd[3], "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "SUB" && isVar(cmd[1]) && isVal(cmd[2]) && isVal(cmd[3])) {
-            uint16_t val1 = static_cast<uint16_t>(std::stoi(cmd[2]));
-            uint16_t val2 = static_cast<uint16_t>(std::stoi(cmd[3]));
-            commands.push_back(new PrintCommand(5, "", INVALID_VAL, cmd[1], val1, val2, "", "", "", "", INVALID_VAL, "", "", "", ""));
-            x+=1;
-        }
-        else if (cmd.size() == 4 && cmd[0] == "PRINT" && cmd[2] == "+" && isVar(cmd[3])) {
-            std::string message = cmd[1];
-            if (!message.empty() &&
-                ((message.front() == '"' && message.back() == '"') ||
-                (message.front() == '"' && message.back() == '"'))) {
-                message = message.substr(1, message.size() - 2);
-            }
 
-            commands.push_back(new PrintCommand(6, "", INVALID_VAL, "", INVALID_VAL, INVALID_VAL, "", "", "", "", INVALID_VAL, "", "", message, cmd[3]));
-            x+=1;
-        }
-        else {
+    Program built;
+    for (const std::vector<std::string>& cmd : commandS) {
+        if (!built.compileTokens(cmd)) {
             std::cerr << "Unrecognized or invalid command.\n";
         }
     }
-    totalLines = x;
+    finishProgram(built);
+    program = Program::intern(std::move(built));
+    loadProgram();
 }
 
-void Process::moveCurrentLine(){
-    this->currentLine++;
+// Sizes the mutable state that goes with the program. While a lazy program is still being
+// generated, every instruction not generated yet counts once.
+void Process::loadProgram() {
+    totalLines = static_cast<int>(program->executedLength() + generator.getRemaining());
+    programBytes.store(program->byteSize(), std::memory_order_relaxed);
+    pc = 0;
+    loopDepth = 0;
+    std::fill(std::begin(registers), std::end(registers), 0);
+    execLogs.assign(program->size(), ExecLog());
 }
 
-std::time_t Process::getStartTime() const {
-    return startTime;
+const char* toString(ProcessState state) {
+    switch (state) {
+    case ProcessState::New: return "New";
+    case ProcessState::Ready: return "Ready";
+    case ProcessState::Running: return "Running";
+    case ProcessState::Blocked: return "Blocked";
+    case ProcessState::Sleeping: return "Sleeping";
+    case ProcessState::Finished: return "Finished";
+    }
+    return "Unknown";
 }
 
-int Process::getUsedMemory() {
-    int totalUsed = 0;
-    for (const std::string& cmd : this->getAllLogs()) {
-        totalUsed += this->getInstructionSize(cmd);
+// Edges of the process state machine; Finished is final
+static bool canTransition(ProcessState from, ProcessState to) {
+    switch (from) {
+    case ProcessState::New: return to == ProcessState::Ready;
+    case ProcessState::Ready: return to == ProcessState::Running;
+    case ProcessState::Running:
+        return to == ProcessState::Ready || to == ProcessState::Blocked || to == ProcessState::Sleeping || to == ProcessState::Finished;
+    case ProcessState::Blocked: return to == ProcessState::Running || to == ProcessState::Ready;
+    case ProcessState::Sleeping: return to == ProcessState::Ready;
+    case ProcessState::Finished:
+        return false;
     }
-    return totalUsed;
+    return false;
 }
 
-//was edited out 
-/*
-void Process::createPrintCommands(int totalIns) {
-    for (int i = 0; i < totalIns; ++i) {
-        std::string msg = "Hello world from " + name + "!";
-        commands.push_back(new PrintCommand(msg));
-    }
-}*/
+bool Process::transition(ProcessState to, std::uint64_t tick) {
+    ProcessState from = state.load(std::memory_order_acquire);
+    do {
+        if (!canTransition(from, to)) return false;
+    } while (!state.compare_exchange_weak(from, to, std::memory_order_acq_rel, std::memory_order_acquire));
+    stateEnteredAt[static_cast<int>(to)].store(tick, std::memory_order_relaxed);
+    return true;
+}
 
-int getRandomInt(int min, int max) {
-    std::uniform_int_distribution<int> dist(min, max);
-    return dist(rng);
+bool Process::transition(ProcessState from, ProcessState to, std::uint64_t tick) {
+    if (!canTransition(from, to)) return false;
+    if (!state.compare_exchange_strong(from, to, std::memory_order_acq_rel, std::memory_order_acquire)) return false;
+    stateEnteredAt[static_cast<int>(to)].store(tick, std::memory_order_relaxed);
+    return true;
 }
 
-std::string ltrim(const std::string& s);
-
-int Process::getInstructionSize(const std::string& instr) {
-    std::string s = ltrim(instr); // Use trimmed string for checks
-    if (s.find("PRINT") == 0) return 1;
-    if (s.find("DECLARE") == 0) return 2;
-    if (s.find("ADD") == 0 || s.find("SUBTRACT") == 0) return 3;
-    if (s.find("SLEEP") == 0) return 1;
-    if (s.find("FOR") == 0) {
-        // Parse FOR([body], count) with nested brackets
-        size_t bodyStart = s.find("[") + 1;
-        int bracketCount = 1;
-        size_t i = bodyStart;
-        while (i < s.size() && bracketCount > 0) {
-            if (s[i] == '[') bracketCount++;
-            else if (s[i] == ']') bracketCount--;
-            i++;
-        }
-        size_t bodyEnd = i - 1;
-        std::string body = s.substr(bodyStart, bodyEnd - bodyStart);
-        size_t countStart = s.find(",", bodyEnd) + 1;
-        size_t countEnd = s.find(")", countStart);
-        int count = std::stoi(s.substr(countStart, countEnd - countStart));
-        int bodySize = getInstructionSize(body);
-        return 1 + bodySize * count;
-    }
-    if (s.find("READ") == 0) return 3;
-    if (s.find("WRITE") == 0) return 2;
-    return 1;
+void Process::recordDispatch(std::uint64_t tick) {
+    std::uint64_t readySince = getStateEnteredAt(ProcessState::Ready);
+    if (tick > readySince) scheduleTimes.waiting += tick - readySince;
+    if (scheduleTimes.dispatches++ == 0) scheduleTimes.firstDispatch = tick;
 }
 
-std::string Process::generateRandomInstruction(int nestingLevel, int& instrBytes, int maxNesting) {
-    static const std::vector<std::string> instrTypes = {
-        "PRINT", "DECLARE", "ADD", "SUBTRACT", "SLEEP", "FOR", "READ", "WRITE"
-    };
-
-    std::string type = instrTypes[getRandomInt(0, instrTypes.size() - 1)];
-    std::string msg;
-    bool skip = false;
-
-    if (type == "FOR" && nestingLevel < maxNesting) {
-        int forCount = getRandomInt(1, 3);
-        int bodyBytes = 0;
-        std::string bodyInstr = generateRandomInstruction(nestingLevel + 1, bodyBytes, maxNesting);
-        msg = "FOR([" + bodyInstr + "], " + std::to_string(forCount) + ")";
-        instrBytes = 1 + bodyBytes * forCount;
-        return msg;
+void Process::recordQuantum(int granted, int used, int faults) {
+    // Halve the weight of older quanta each dispatch
+    if (used > 0) {
+        faultRate = 0.5f * faultRate + 0.5f * (static_cast<float>(faults) / used);
     }
-
-    if (type == "PRINT") {
-        msg = "PRINT(\"Hello world from process!\")";
-        instrBytes = 1;
-    } else if (type == "DECLARE") {
-        // Find the first undeclared variable in ascending order
-        int nextIndex = -1;
-        for (int i = 1; i <= 32; ++i) {
-            if (!variables[i].declared) {
-                nextIndex = i;
-                break;
-            }
-        }
-        if (nextIndex == -1) {
-            instrBytes = 0;
-            return ""; // All variables already declared, skip
-        }
-        std::string var = "var" + std::to_string(nextIndex);
-        uint16_t value = getRandomInt(0, 65535);
-        variables[nextIndex].value = value;
-        variables[nextIndex].declared = true; // Mark as declared
-        msg = "DECLARE(" + var + ", " + std::to_string(value) + ")";
-        instrBytes = 2;
-    } else if (type == "ADD" || type == "SUBTRACT") {
-        int targetIdx = getRandomInt(1, 32);
-        int src1Idx = getRandomInt(1, 32);
-        int src2Idx = getRandomInt(1, 32);
-        std::string target = "var" + std::to_string(targetIdx);
-        std::string src1 = (getRandomInt(0, 1) == 0)
-            ? std::to_string(getRandomInt(0, 100))
-            : "var" + std::to_string(src1Idx);
-        std::string src2 = (getRandomInt(0, 1) == 0)
-            ? std::to_string(getRandomInt(0, 100))
-            : "var" + std::to_string(src2Idx);
-        // Mark all variables used as declared (with value 0 if not already)
-        variables[targetIdx].declared = true;
-        variables[src1Idx].declared = true;
-        variables[src2Idx].declared = true;
-        msg = type + "(" + target + ", " + src1 + ", " + src2 + ")";
-        instrBytes = 3;
-    } else if (type == "SLEEP") {
-        int ticks = getRandomInt(1, 50);
-        msg = "SLEEP(" + std::to_string(ticks) + ")";
-        instrBytes = 1;
-    } else if (type == "READ") {
-        // Collect declared variables
-        std::vector<std::string> usableVars;
-        for (const auto& [idx, v] : variables) {
-            if (v.declared) usableVars.push_back(v.varname);
-        }
-        if (usableVars.empty()) {
-            instrBytes = 0;
-            return ""; // Skip generating this instruction
-        }
-        int varIdx = getRandomInt(0, usableVars.size() - 1);
-        std::string var = usableVars[varIdx];
-
-        int baseAddr = 0x0040;
-        int maxEvenAddr = baseAddr + memSize - 2; // Exclude the last even address
-        int addr = baseAddr;
-        if (maxEvenAddr >= baseAddr) {
-            int numEvenAddrs = ((maxEvenAddr - baseAddr) / 2) + 1;
-            int offset = getRandomInt(0, numEvenAddrs - 1) * 2;
-            addr = baseAddr + offset;
-        }
-        std::stringstream ss;
-        ss << "0x" << std::hex << addr;
-        msg = "READ " + var + " " + ss.str();
-        instrBytes = 3;
-    } else if (type == "WRITE") {
-        int baseAddr = 0x0040;
-        int maxEvenAddr = baseAddr + memSize - 2; // Exclude the last even address
-        int addr = baseAddr;
-        if (maxEvenAddr >= baseAddr) {
-            int numEvenAddrs = ((maxEvenAddr - baseAddr) / 2) + 1;
-            int offset = getRandomInt(0, numEvenAddrs - 1) * 2;
-            addr = baseAddr + offset;
-        }
-        int value = getRandomInt(0, 65535);
-        std::stringstream ss;
-        ss << "0x" << std::hex << addr;
-        msg = "WRITE " + ss.str() + " " + std::to_string(value);
-        instrBytes = 2;
+    if (granted > 0) {
+        quantumUsage = 0.5f * quantumUsage + 0.5f * (static_cast<float>(used) / granted);
     }
-
-    return msg;
 }
 
-void Process::createPrintCommands(int totalIns) {
-    declaredVars.clear(); // <-- Add this line at the start
+void Process::createPrintCommands(int totalIns, std::uint64_t seed) {
+    Program built;
     if (name.find("auto_proc_") != 0) {
+        SplitMix64 rng(seed);
         int xVal = 0;
         for (int i = 0; i < totalIns; ++i) {
             std::string msg;
             if (i % 2 == 0) {
                 msg = "PRINT(\"Value from: " + std::to_string(xVal) + ")";
             } else {
-                int addVal = getRandomInt(1, 10);
+                int addVal = rng.range(1, 10);
                 msg = "ADD(x, x, " + std::to_string(addVal) + ")";
                 xVal += addVal;
             }
-            commands.push_back(new PrintCommand(msg));
+            built.compileLine(msg);
         }
+        finishProgram(built);
+        program = Program::intern(std::move(built));
+        loadProgram();
         return;
     }
 
-    int i = 0;
-    int var_count = 0;
-    while (i < totalIns) {
-        int instrBytes = 0;
-        std::string msg = generateRandomInstruction(0, instrBytes, 3);
-        commands.push_back(new PrintCommand(msg));
-        i++; // Always increment by 1 instruction
-    }
+    generator = ProgramGenerator(seed, totalIns, memSize);
+    generator.generate(built, totalIns);
+    finishProgram(built);
+    program = Program::intern(std::move(built));
+    loadProgram();
 }
 
-void Process::executeCurrentCommand(int cpuId, std::string processName, std::string time) {
-    if (currentLine < commands.size()) {
-        commands[currentLine]->execute(cpuId, processName, std::time(nullptr));
+void Process::createLazyProgram(int totalIns, std::uint64_t seed) {
+    generator = ProgramGenerator(seed, totalIns, memSize);
+    lazyProgram = true;
+    loadProgram();
+}
+
+// Lazy mode: the current chunk has run to completion (so no loop is open); replace it with the next one.
+// Chunks are private to the process and never interned; the symbol table carries over.
+void Process::nextProgramChunk() {
+    codeBase += program->size();
+    auto chunk = std::make_shared<Program>(*program);
+    chunk->clearCode();
+    generator.generate(*chunk, GENERATION_CHUNK);
+    finishProgram(*chunk);
+    // The copy carried the byte count over, so the difference is what this chunk added
+    programBytes.fetch_add(chunk->byteSize() - program->byteSize(), std::memory_order_relaxed);
+    pc = 0;
+    std::lock_guard<std::mutex> lock(logMutex);
+    program = std::move(chunk);
+    execLogs.assign(program->size(), ExecLog());
+    totalLines = static_cast<int>(program->executedLength() + generator.getRemaining());
+}
+
+void Process::executeCurrentCommand(int cpuId) {
+    if (pc >= program->size()) return;
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    execLogs[pc] = ExecLog{steadyNanos(), static_cast<std::int16_t>(cpuId)};
+}
+
+void Process::visitLogs(size_t limit, const std::function<void(const std::string&)>& visit) const {
+    std::lock_guard<std::mutex> lock(logMutex);
+    std::uint32_t first = static_cast<std::uint32_t>(execLogs.size());
+    for (size_t found = 0; first > 0 && found < limit; --first) {
+        if (execLogs[first - 1].time != 0) ++found;
+    }
+    std::string line;
+    for (std::uint32_t i = first; i < execLogs.size(); ++i) {
+        if (execLogs[i].time == 0) continue;
+        line.clear();
+        appendTime(line, execLogs[i].time, TimeFormat::Log);
+        line += "    Core:";
+        line += std::to_string(execLogs[i].core);
+        line += "    \"";
+        line += program->disassemble(i);
+        line += '"';
+        visit(line);
     }
 }
 
@@ -343,102 +207,187 @@ int Process::getEndAddress() const{
     return endAddress;
 }
 
-// setEndTime, getEndTime, getEndTimeString are now implemented inline in the header, so no additional implementation needed here.
-
-// Helper to trim leading spaces
-std::string ltrim(const std::string& s) {
-    size_t start = s.find_first_not_of(" \t\n\r");
-    return (start == std::string::npos) ? "" : s.substr(start);
+// Records the PRINT at op: ids and the variable's value only, the text is put together by readers
+void Process::logPrint(const Op& op)
+{
+    LogRecord record;
+    record.time = steadyNanos();
+    record.pid = static_cast<std::uint32_t>(pid);
+    record.format = program->formatOf(op);
+    record.core = static_cast<std::int16_t>(cpuId);
+    record.hasValue = op.code == OpCode::Print && (op.flags & Op::HAS_VAR);
+    record.value = record.hasValue ? registers[op.a] : 0;
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        printTail[printCount++ % PRINT_TAIL] = record;
+    }
+    logSink.push(record);
 }
 
-bool Process::isVar(std::string s)
+std::vector<std::string> Process::getPrintLog() const
 {
-    if (s.empty()) return false;
-
-    // First character must be a letter or underscore
-    if (!std::isalpha(s[0]) && s[0] != '_') return false;
-
-    // Remaining characters can be alphanumeric or underscore
-    for (size_t i = 1; i < s.length(); ++i) {
-        if (!std::isalnum(s[i]) && s[i] != '_') return false;
+    std::vector<std::string> lines;
+    std::lock_guard<std::mutex> lock(logMutex);
+    std::uint32_t kept = std::min<std::uint32_t>(printCount, PRINT_TAIL);
+    for (std::uint32_t i = printCount - kept; i < printCount; ++i) {
+        lines.push_back(logSink.format(printTail[i % PRINT_TAIL]));
     }
-
-    return true;
+    return lines;
 }
 
-bool Process::isMemAdd(std::string s)
+void Process::printLog()
 {
-    static const std::unordered_set<std::string> validAddresses = {
-        "0x100", "0x200", "0x300", "0x400", "0x500",
-        "0x600", "0x700", "0x800", "0x900", "0x1000"
-    };
-
-    return validAddresses.count(s) > 0;
+    for (const std::string& statement : getPrintLog()) {
+        std::cout << statement << std::endl;
+    }
 }
 
-
-bool Process::isVal(std::string s)
+// Runs until the program ends, suspending after every instruction and on page-ins and sleeps.
+// executeCurrentCommand2 (or retireAlu, in batch mode) advances currentLine itself.
+ProcessTask Process::run(MemoryManager* memory, int pageFaultTicks)
 {
-    if (s.empty()) return false;
-
-    size_t i = 0;
-    if (s[0] == '-' || s[0] == '+') i = 1;
+    const bool batchAlu = execution_mode == "batch";
+    // Page checked last and the eviction count then: while neither changes it is still resident
+    int residentPage = -1;
+    std::uint64_t residentEpoch = 0;
+    while (!isFinished()) {
+        if (lazyProgram && pc >= program->size()) nextProgramChunk();
+
+        int pageNumber = static_cast<int>((codeBase + pc) / mem_per_frame) - 1;
+        if (pageNumber < 0) pageNumber = 0;
+        if (pageNumber != residentPage || memory->getEvictionEpoch() != residentEpoch) {
+            bool pageFault = false;
+            memory->accessPage(name, pageNumber, &pageFault);
+            residentPage = pageNumber;
+            residentEpoch = memory->getEvictionEpoch();
+            if (pageFault) {
+                pageFaults++;
+                co_await PageIn{pageFaultTicks};
+            }
+        }
 
-    for (; i < s.size(); ++i) {
-        if (!isdigit(s[i])) return false;
+        executeCurrentCommand(cpuId);
+        if (batchAlu && pc < program->size()) {
+            OpCode code = program->at(pc).code;
+            if (code == OpCode::Declare || code == OpCode::Add || code == OpCode::Sub) {
+                // The host executes it with this tick's other ALU ops; that stands in for NextTick
+                co_await AluStep{};
+                continue;
+            }
+        }
+        executeCurrentCommand2();
+
+        if (sleepTicks > 0) {
+            int ticks = sleepTicks;
+            sleepTicks = 0;
+            co_await SleepFor{ticks};
+        } else {
+            co_await NextTick{};
+        }
     }
-
-    return true;
 }
 
-
-void Process::createStringCommands()
+SliceResult Process::executeSlice(int maxSteps, int budget)
 {
+    SliceResult result;
+    while (result.steps < maxSteps && result.ticks < budget && !task.done()) {
+        task.resume();
+        result.steps++;
+        result.ticks++;
+        result.stop = task.reason();
+        result.waitTicks = task.waitTicks();
+        if (isFinished() || (result.stop != SuspendReason::Tick && result.stop != SuspendReason::Alu)) break;
+
+        int delay = std::min(delay_per_exec, budget - result.ticks);
+        result.ticks += delay;
+        result.delayLeft = delay_per_exec - delay;
+        // A pending ALU op has to be retired by the host before the next resume
+        if (result.stop == SuspendReason::Alu || result.delayLeft > 0) break;
+    }
+    return result;
 }
 
-void Process::logPrint(std::string log)
+// Executes the op at pc, then moves pc to the next op that takes a tick
+void Process::executeCurrentCommand2()
 {
-    // Get current time
-    std::time_t now = std::time(nullptr);
-    std::tm localTime;
-
-    #ifdef _WIN32
-        localtime_s(&localTime, &now);
-    #else
-        localtime_r(&now, &localTime);
-    #endif
-
-    // Format timestamp
-    std::ostringstream timeStream;
-    timeStream << std::put_time(&localTime, "(%m/%d/%Y %I:%M:%S%p)");
-
-    std::string finalLog;
-
-    if (n == 0) {
-        finalLog = timeStream.str() + "    Variable A: 15";
-    printStatements.push_back(finalLog);
-    finalLog = timeStream.str() + "    Result: 15";
-    printStatements.push_back(finalLog);
-    } else if (n == 1) {
-        finalLog = timeStream.str() + "    Result: 15";
-    } else {
-        // For n >= 2, use the actual log passed in
-        finalLog = timeStream.str() + "    " + log;
+    std::uint32_t lines = 1;
+    if (pc < program->size()) {
+        const Op& op = program->at(pc);
+        lines = program->weightOf(pc);
+        if (op.code == OpCode::For) {
+            if (op.a > 0) {
+                loopStack[loopDepth++] = {pc, op.a};
+                pc++;
+            } else {
+                pc = op.wide() + 1;
+            }
+        } else {
+            executeOp(op);
+            pc++;
+        }
     }
-    n += 1;
+    finishStep(lines);
 }
 
-void Process::printLog()
+// Resolves the loop ends after an executed op and counts its source lines
+void Process::finishStep(std::uint32_t lines)
 {
-    for (const std::string& statement : printStatements) {
-        std::cout << statement << std::endl;
+    // Loop ends are bookkeeping: either jump back to the body or pop the frame
+    while (pc < program->size() && program->at(pc).code == OpCode::EndFor) {
+        LoopFrame& frame = loopStack[loopDepth - 1];
+        if (--frame.remaining > 0) {
+            pc = frame.header + 1;
+        } else {
+            loopDepth--;
+            pc++;
+        }
     }
+    currentLine.store(currentLine.load(std::memory_order_relaxed) + static_cast<int>(lines), std::memory_order_relaxed); // source lines, so optimized programs report the same progress
 }
 
-void Process::executeCurrentCommand2()
+// Completes the DECLARE/ADD/SUB that run() suspended on with the value the batch computed
+void Process::retireAlu(std::uint16_t value)
+{
+    std::uint32_t lines = program->weightOf(pc);
+    registers[program->at(pc).a] = value;
+    pc++;
+    finishStep(lines);
+}
+
+void Process::executeOp(const Op& op)
 {
-    if (currentLine < commands.size()) {
-        commands[currentLine]->execute2(*this);
+    auto operandB = [&] { return (op.flags & Op::IMM_B) ? op.b : registers[op.b]; };
+    auto operandC = [&] { return (op.flags & Op::IMM_C) ? op.c : registers[op.c]; };
+    switch (op.code) {
+    case OpCode::Nop:
+        break;
+    case OpCode::Declare:
+        registers[op.a] = op.b;
+        break;
+    case OpCode::Add:
+        registers[op.a] = operandB() + operandC();
+        break;
+    case OpCode::Sub:
+        registers[op.a] = operandB() - operandC();
+        break;
+    case OpCode::Write:
+        memoryAddSpace[op.a] = operandB();
+        break;
+    case OpCode::Read:
+        registers[op.a] = memoryAddSpace[op.b];
+        break;
+    case OpCode::Print:
+        logPrint(op);
+        break;
+    case OpCode::Sleep:
+        requestSleep(op.b);
+        break;
+    case OpCode::PrintRun:
+        for (int i = 0; i < op.a; ++i) logPrint(op);
+        break;
+    case OpCode::For:
+    case OpCode::EndFor:
+        // Control flow is handled by executeCurrentCommand2
+        break;
     }
-    currentLine++;
 }
@@ -2,130 +2,202 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <ctime>
 #include <map>
 #include <variant>
 #include <functional>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
-#include "PrintCommand.h"
+#include <atomic>
+#include "Program.h"
+#include "ProgramGenerator.h"
+#include "ProcessTask.h"
+#include "LogSink.h"
+#include "Timestamp.h"
 
-struct var_map {
-    uint16_t value;
-    std::string varname;
-    bool declared = false;
+class MemoryManager;
+
+// Scheduling state. Schedulers move it through Process::transition; monitors read it lock-free.
+enum class ProcessState : std::uint8_t {
+    New,        // created, not handed to a scheduler yet
+    Ready,      // queued for a core
+    Running,    // on a core
+    Blocked,    // on a core, waiting for a page-in
+    Sleeping,   // off the cores until its SLEEP timer fires
+    Finished,
+};
+static const int PROCESS_STATE_COUNT = 6;
+
+// Scheduling history in scheduler ticks. Written by the owning scheduler under its queue lock.
+struct ScheduleTimes {
+    std::uint64_t arrival = 0;
+    std::uint64_t firstDispatch = 0;
+    std::uint64_t completion = 0;
+    std::uint64_t waiting = 0; // ticks spent Ready, summed over every wait
+    int dispatches = 0;
+    int preemptions = 0;
 };
 
-class Instruction;
+const char* toString(ProcessState state);
+
+// What one executeSlice call did
+struct SliceResult {
+    int steps = 0;      // resumes on the core: instructions run, or the faulting attempt of a page-in
+    int ticks = 0;      // steps plus the delay-per-exec ticks spent after them
+    int delayLeft = 0;  // delay-per-exec still owed when the budget ran out
+    int waitTicks = 0;  // page-in or sleep length, per stop
+    SuspendReason stop = SuspendReason::Tick; // Tick: ran out of steps or budget
+};
 
 class Process {
 private:
     int pid;
     std::string name;
-    int currentLine;
-    int totalLines;
-    std::string timestamp;
-    std::string status;
+    // Written by the core running the process, read by the console
+    std::atomic<int> currentLine{0}; // instructions executed so far
+    std::atomic<int> totalLines{0}; // instructions a full run executes, loop iterations included
+    Timestamp created;
+    std::atomic<ProcessState> state{ProcessState::New};
+    std::atomic<std::uint64_t> stateEnteredAt[PROCESS_STATE_COUNT] = {}; // scheduler tick of the last entry to each state
+    std::atomic<bool> attached{false}; // a console screen session is open on it
+    ScheduleTimes scheduleTimes;
     int cpuId;
-    std::time_t startTime;
-    std::string endTime;
-    std::vector<PrintCommand*> commands;
-    std::map<int, var_map> variables; // symbol table for variables
-    std::vector<Instruction*> instructions;
-    int instructionPointer = 0;
-    int sleepTicks = 0;
+    Timestamp ended; // set by the scheduler when it finishes
+    std::shared_ptr<const Program> program = Program::emptyImage(); // shared, immutable image
+    std::uint16_t registers[Program::MAX_VARIABLES] = {}; // symbol table, indexed by the program's slots
+    std::uint32_t pc = 0; // next op in the program
+
+    // Active FOR loops, innermost last
+    struct LoopFrame {
+        std::uint32_t header; // index of the For op
+        std::uint16_t remaining; // iterations left, including the current one
+    };
+    LoopFrame loopStack[Program::MAX_LOOP_DEPTH];
+    int loopDepth = 0;
+    // Last execution of each line, for process-smi; the line's text comes from the program
+    struct ExecLog {
+        std::int64_t time = 0; // steadyNanos(), 0 = not executed yet
+        std::int16_t core = -1;
+    };
+    std::vector<ExecLog> execLogs;
+    // Held by the core while it swaps in a lazy chunk or writes execLogs/printTail, and by
+    // console readers of the program and logs
+    mutable std::mutex logMutex;
+    ProgramGenerator generator; // source of the rest of the program in lazy mode
+    bool lazyProgram = false;
+    std::uint64_t codeBase = 0; // ops already generated, run and dropped (lazy mode)
+    std::atomic<std::uint64_t> programBytes{0}; // every op generated so far, all chunks in lazy mode
+    int sleepTicks = 0; // set by SLEEP, consumed by run()
+    uint64_t wakeTick = 0; // scheduler tick the current sleep ends on
     int memSize = 0; // memory allocated to this process (bytes)
-    std::vector<std::string> declaredVars; // <-- Add this line
-    int n = 0;
+    int weight = 1024; // CFS share, 1024 = nice 0
+    uint64_t vruntime = 0; // weighted virtual runtime (CFS)
+    int migrations = 0; // times dispatched on a core other than the last one
+    float faultRate = 0.0f; // recent page faults per executed instruction (EWMA)
+    float quantumUsage = 1.0f; // recent fraction of the granted quantum actually used (EWMA)
+    int pageFaults = 0;
+    ProcessTask task; // execution coroutine, created on first dispatch
+    void loadProgram();
+    void nextProgramChunk();
+    void finishStep(std::uint32_t lines);
+
+    // Last PRINTs, for process-smi; the full log goes to the LogSink
+    static const int PRINT_TAIL = 10;
+    LogRecord printTail[PRINT_TAIL];
+    std::uint32_t printCount = 0; // PRINTs executed so far
+    void logPrint(const Op& op);
 
 public:
-    std::unordered_map<std::string, std::uint16_t> declaredVarss;
-    // "var1" = 1
-    // "var2" = 3
-
-    std::unordered_map<std::string, std::uint16_t> memoryAddSpace = {
-    {"0x100", 0},
-    {"0x200", 0},
-    {"0x300", 0},
-    {"0x400", 0},
-    {"0x500", 0},
-    {"0x600", 0},
-    {"0x700", 0},
-    {"0x800", 0},
-    {"0x900", 0},
-    {"0x1000", 0}
-    };
+    std::unordered_map<std::uint16_t, std::uint16_t> memoryAddSpace; // address -> value, unwritten reads as 0
 
-    std::vector<std::vector<std::string>> commandOfStrings;
-    bool isVar(std::string s);
-    bool isMemAdd(std::string s);
-    bool isVal(std::string s);
-    void createStringCommands();
-    std::vector<std::string> printStatements; // logs
-    void logPrint(std::string log);
     void printLog();
-    std::vector<std::vector<std::string>> stringCommands;
+    // The PRINT tail, formatted, oldest first
+    std::vector<std::string> getPrintLog() const;
     void executeCurrentCommand2();
-    //std::uint32_t currentLine = 0;
-    //std::string pName;
+    void executeOp(const Op& op);
 
-    //added
-    uint16_t getVariable(const std::string& name) const;
-    void setVariable(const std::string& name, uint16_t value);
-    //end added
+    // Batch mode (see BatchInterpreter): the op run() left pending, its operands, and completing it
+    const Op& currentOp() const { return program->at(pc); }
+    std::uint16_t operandValue(std::uint16_t operand, bool immediate) const { return immediate ? operand : registers[operand]; }
+    void retireAlu(std::uint16_t value);
     void setCpuId(int id) { cpuId = id; }
     int getCpuId() const { return cpuId; }
-    void addCommand(PrintCommand* cmd) { commands.push_back(cmd); }
-    void createPrintCommands(int totalIns);
-    void executeCurrentCommand(int cpuId, std::string processName, std::string time);
-    void addInstruction(Instruction* instr) { instructions.push_back(instr); }
+    void createPrintCommands(int totalIns, std::uint64_t seed);
+    // Lazy mode: keep only the generator and produce the program in chunks as it runs
+    void createLazyProgram(int totalIns, std::uint64_t seed);
+    std::uint64_t getSeed() const { return generator.getSeed(); }
+    void executeCurrentCommand(int cpuId);
 
     Process();
-    Process(int pid, const std::string& name, int currentLine, int totalLines, const std::string& timestamp, const std::string& status, int memSize);
+    Process(int pid, const std::string& name, int currentLine, int totalLines, Timestamp created, int memSize);
     Process(int pid, std::string processName, int memSize);
     ~Process() = default;
 
     // For screen -c
-    Process(int pid, const std::string& name, int currentLine, const std::string& timestamp, const std::string& status, int memSize, std::vector<std::vector<std::string>> commandS);
+    Process(int pid, const std::string& name, int currentLine, Timestamp created, int memSize, std::vector<std::vector<std::string>> commandS);
 
     int getPid() const { return pid; }
     const std::string& getName() const { return name; }
-    int getCurrentLine() const { return currentLine; }
-    int getTotalLines() const { return totalLines; }
-    const std::string& getTimestamp() const { return timestamp; }
-    const std::string& getStatus() const { return status; }
+    int getCurrentLine() const { return currentLine.load(std::memory_order_relaxed); }
+    int getTotalLines() const { return totalLines.load(std::memory_order_relaxed); }
+    const Timestamp& getTimestamp() const { return created; }
+    ProcessState getState() const { return state.load(std::memory_order_acquire); }
+    std::uint64_t getStateEnteredAt(ProcessState s) const { return stateEnteredAt[static_cast<int>(s)].load(std::memory_order_relaxed); }
+    // Moves to `to` if the state machine allows it from the current state; false otherwise
+    bool transition(ProcessState to, std::uint64_t tick);
+    // Same, but only from exactly `from` (e.g. claiming a Ready process for a core)
+    bool transition(ProcessState from, ProcessState to, std::uint64_t tick);
+    // Latency bookkeeping; recordDispatch must follow the Ready -> Running transition
+    void recordArrival(std::uint64_t tick) { scheduleTimes.arrival = tick; }
+    void recordDispatch(std::uint64_t tick);
+    void recordPreemption() { scheduleTimes.preemptions++; }
+    void recordCompletion(std::uint64_t tick) { scheduleTimes.completion = tick; }
+    const ScheduleTimes& getScheduleTimes() const { return scheduleTimes; }
+    bool isAttached() const { return attached.load(std::memory_order_relaxed); }
+    void setAttached(bool value) { attached.store(value, std::memory_order_relaxed); }
     int getMemSize() const { return memSize; }
     void setMemSize(int size) { memSize = size; }
-    int getUsedMemory();
+    // Bytes of the program's instructions: fixed when it was built, or in lazy mode the sum of
+    // the chunks generated so far
+    int getUsedMemory() const { return static_cast<int>(programBytes.load(std::memory_order_relaxed)); }
     int getEndAddress() const;
-    int getInstructionSize(const std::string& instr);
-    std::string generateRandomInstruction(int nestingLevel, int& instrBytes, int maxNesting = 3);
-    std::string parseInstructions(std::string& input);
-
-    void setStatus(const std::string& newStatus) { status = newStatus; };
-    void moveCurrentLine();
-    std::time_t getStartTime() const;
-    void setEndTime(std::string t) { endTime = t; };
-    std::string getEndTime() const { return endTime; };
-    std::string getEndTimeString();
-    std::vector<std::string> getAllLogs() const {
-        std::vector<std::string> logs;
-        for (const auto* cmd : commands) {
-            logs.push_back(cmd->getLog());
-        }
-        return logs;
-    }
+
+    void setEndTime(Timestamp t) { ended = t; };
+    const Timestamp& getEndTime() const { return ended; };
+    // Formats the last execution of each executed line of the current program (or chunk), at
+    // most the last `limit` of them, and hands each line to `visit` as it is built
+    void visitLogs(size_t limit, const std::function<void(const std::string&)>& visit) const;
     void setPid(int id) { pid = id; };
 
-    // RR/OS-style helpers
-    bool isFinished() const { return currentLine >= totalLines; }
-    std::vector<std::string> getAllInstructions() const {
-        std::vector<std::string> instrs;
-        for (const auto* cmd : commands) {
-            instrs.push_back(cmd->getInstruction());
-        }
-        return instrs;
+    // CFS helpers
+    int getWeight() const { return weight; }
+    void setWeight(int w) { weight = w > 0 ? w : 1; }
+    uint64_t getVruntime() const { return vruntime; }
+    void setVruntime(uint64_t v) { vruntime = v; }
+    int getMigrations() const { return migrations; }
+    void addMigration() { migrations++; }
+
+    // Adaptive quantum feedback
+    float getFaultRate() const { return faultRate; }
+    float getQuantumUsage() const { return quantumUsage; }
+    void recordQuantum(int granted, int used, int faults);
+    int getPageFaults() const { return pageFaults; }
+
+    // SLEEP: the process gives up its core until the scheduler's timer wheel wakes it
+    void requestSleep(int ticks) { sleepTicks = ticks; }
+    uint64_t getWakeTick() const { return wakeTick; }
+    void setWakeTick(uint64_t tick) { wakeTick = tick; }
+
+    // Coroutine execution: the scheduler resumes the task once per tick on a core
+    ProcessTask run(MemoryManager* memory, int pageFaultTicks);
+    ProcessTask& getTask() { return task; }
+    void startTask(MemoryManager* memory, int pageFaultTicks) {
+        if (!task.valid()) task = run(memory, pageFaultTicks);
     }
-    std::vector<std::string>& getDeclaredVars() { return declaredVars; } // Optional getter
+    // Runs up to maxSteps steps within budget ticks (each followed by delay-per-exec), stopping
+    // early on a page-in, sleep, finish or batch ALU op
+    SliceResult executeSlice(int maxSteps, int budget);
+
+    // RR/OS-style helpers
+    bool isFinished() const { return getCurrentLine() >= getTotalLines(); }
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "ProcessArchive.h"
+#include <algorithm>
+
+ProcessSummary ProcessSummary::of(const Process& proc) {
+    ProcessSummary summary;
+    summary.pid = proc.getPid();
+    summary.name = proc.getName();
+    summary.timestamp = proc.getTimestamp();
+    summary.endTime = proc.getEndTime();
+    summary.totalLines = proc.getTotalLines();
+    summary.memSize = proc.getMemSize();
+    summary.migrations = proc.getMigrations();
+    summary.times = proc.getScheduleTimes();
+
+    // Execution logs then PRINT output, as process-smi shows them, keeping only the last LOG_TAIL
+    std::vector<std::string> logs;
+    proc.visitLogs(LOG_TAIL, [&logs](const std::string& line) { logs.push_back(line); });
+    std::vector<std::string> prints = proc.getPrintLog();
+    logs.insert(logs.end(), std::make_move_iterator(prints.begin()), std::make_move_iterator(prints.end()));
+    size_t first = logs.size() > LOG_TAIL ? logs.size() - LOG_TAIL : 0;
+    summary.logTail.assign(std::make_move_iterator(logs.begin() + first), std::make_move_iterator(logs.end()));
+    return summary;
+}
+
+bool ArchiveQuery::matches(const ProcessSummary& entry) const {
+    return entry.name.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool ProcessArchive::append(ProcessSummary summary, ProcessSummary& dropped) {
+    ++total;
+    if (entries.size() < capacity) {
+        entries.push_back(std::move(summary));
+        return false;
+    }
+    ProcessSummary& slot = entries[(total - 1) % capacity];
+    dropped = std::move(slot);
+    slot = std::move(summary);
+    return true;
+}
+
+bool ProcessArchive::select(const ArchiveQuery& query, std::vector<ProcessSummary>& out) const {
+    if (!query.filtered()) {
+        if (query.offset >= total - first()) return false;
+        size_t end = total - query.offset;
+        size_t begin = end - first() > query.limit ? end - query.limit : first();
+        for (size_t i = begin; i < end; ++i) out.push_back((*this)[i]);
+        return begin > first();
+    }
+
+    size_t start = out.size();
+    size_t skipped = 0;
+    bool more = false;
+    for (size_t i = total; i-- > first();) {
+        const ProcessSummary& entry = (*this)[i];
+        if (!query.matches(entry)) continue;
+        if (skipped < query.offset) {
+            ++skipped;
+            continue;
+        }
+        if (out.size() - start == query.limit) {
+            more = true;
+            break;
+        }
+        out.push_back(entry);
+    }
+    std::reverse(out.begin() + start, out.end());
+    return more;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "Process.h"
+
+// What is kept of a process after it leaves its scheduler: enough for screen -ls, screen -r and
+// report-util, without the program, registers, page table or coroutine frame
+struct ProcessSummary {
+    static const int LOG_TAIL = 10; // most recent log lines kept
+
+    int pid = 0;
+    std::string name;
+    Timestamp timestamp; // created
+    Timestamp endTime;
+    int totalLines = 0;
+    int memSize = 0;
+    int migrations = 0;
+    ScheduleTimes times;
+    std::vector<std::string> logTail;
+
+    static ProcessSummary of(const Process& proc);
+};
+
+// A page of archive entries: matches are counted back from the newest, `offset` of them skipped
+// and at most `limit` returned
+struct ArchiveQuery {
+    std::string prefix;   // name prefix, empty for all
+    bool finished = true; // list finished processes at all
+    size_t offset = 0;
+    size_t limit = 50;
+
+    bool filtered() const { return !prefix.empty(); }
+    bool matches(const ProcessSummary& entry) const;
+};
+
+// Finished processes in completion order. Entries keep their position for good, but only the
+// newest `capacity` are kept: once full, each append drops the oldest. size() still counts every
+// process ever archived.
+class ProcessArchive {
+public:
+    static const size_t DEFAULT_CAPACITY = 10000;
+
+    // Only while empty
+    void setCapacity(size_t n) { capacity = n > 0 ? n : 1; }
+    // Returns true when the oldest entry had to make room; it is moved into `dropped`
+    bool append(ProcessSummary summary, ProcessSummary& dropped);
+    // Processes archived so far, kept or not; the next append gets this position
+    size_t size() const { return total; }
+    // Oldest position still kept
+    size_t first() const { return total - entries.size(); }
+    bool contains(size_t position) const { return position >= first() && position < total; }
+    const ProcessSummary& operator[](size_t position) const { return entries[position % capacity]; }
+    // Appends the page to `out`, oldest first; returns whether older kept matches remain.
+    // Unfiltered queries index the page directly; filtered ones scan back only until the page is full.
+    bool select(const ArchiveQuery& query, std::vector<ProcessSummary>& out) const;
+
+private:
+    std::vector<ProcessSummary> entries; // position p lives at p % capacity
+    size_t capacity = DEFAULT_CAPACITY;
+    size_t total = 0;
+};
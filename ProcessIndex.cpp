@@ -0,0 +1,60 @@
+#include "ProcessIndex.h"
+#include "Process.h"
+#include <mutex>
+
+void ProcessIndex::insert(Process* proc) {
+    IndexEntry entry;
+    entry.pid = proc->getPid();
+    entry.live = proc;
+    put(proc->getName(), entry);
+}
+
+void ProcessIndex::archive(const Process* proc, size_t position) {
+    IndexEntry entry;
+    entry.pid = proc->getPid();
+    entry.archived = static_cast<long long>(position);
+    put(proc->getName(), entry);
+}
+
+// One shard lock at a time, so a lookup can briefly see the name and pid tables disagree
+void ProcessIndex::put(const std::string& name, const IndexEntry& entry) {
+    {
+        Shard<std::string>& shard = nameShard(name);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.entries[name] = entry;
+    }
+    Shard<int>& shard = pidShard(entry.pid);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.entries[entry.pid] = entry;
+}
+
+void ProcessIndex::remove(const std::string& name, int pid) {
+    {
+        Shard<std::string>& shard = nameShard(name);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(name);
+        if (it != shard.entries.end() && it->second.pid == pid) shard.entries.erase(it);
+    }
+    Shard<int>& shard = pidShard(pid);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(pid);
+    if (it != shard.entries.end() && it->second.live == nullptr) shard.entries.erase(it);
+}
+
+bool ProcessIndex::findByName(const std::string& name, IndexEntry& out) const {
+    const Shard<std::string>& shard = nameShard(name);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(name);
+    if (it == shard.entries.end()) return false;
+    out = it->second;
+    return true;
+}
+
+bool ProcessIndex::findByPid(int pid, IndexEntry& out) const {
+    const Shard<int>& shard = pidShard(pid);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(pid);
+    if (it == shard.entries.end()) return false;
+    out = it->second;
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstddef>
+
+class Process;
+
+// Where a process is: on its scheduler while live, in the scheduler's ProcessArchive once finished
+struct IndexEntry {
+    int pid = -1;
+    Process* live = nullptr;   // nullptr once finished; dereference only under a ProcessReclaimer::Guard
+    long long archived = -1;   // position in the archive once finished
+};
+
+// Name -> process and pid -> process lookup, kept up to date by the scheduler on admission and
+// completion. Each key hashes to one of SHARDS independently locked tables, so lookups from the
+// console only ever contend with the one update that lands on the same shard.
+class ProcessIndex {
+public:
+    void insert(Process* proc);
+    // The process finished and now lives at `position` in the archive
+    void archive(const Process* proc, size_t position);
+    // The archive dropped the process; forgets it unless the name or pid has been reused since
+    void remove(const std::string& name, int pid);
+
+    bool findByName(const std::string& name, IndexEntry& out) const;
+    bool findByPid(int pid, IndexEntry& out) const;
+
+private:
+    static const int SHARDS = 16;
+
+    template <typename Key>
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, IndexEntry> entries;
+    };
+
+    void put(const std::string& name, const IndexEntry& entry);
+    Shard<std::string>& nameShard(const std::string& name) { return byName[std::hash<std::string>()(name) % SHARDS]; }
+    const Shard<std::string>& nameShard(const std::string& name) const { return byName[std::hash<std::string>()(name) % SHARDS]; }
+    Shard<int>& pidShard(int pid) { return byPid[static_cast<unsigned>(pid) % SHARDS]; }
+    const Shard<int>& pidShard(int pid) const { return byPid[static_cast<unsigned>(pid) % SHARDS]; }
+
+    Shard<std::string> byName[SHARDS];
+    Shard<int> byPid[SHARDS];
+};
@@ -0,0 +1,79 @@
+#include "ProcessReclaimer.h"
+#include "Process.h"
+#include <limits>
+#include <thread>
+
+ProcessReclaimer processReclaimer;
+
+struct ProcessReclaimer::ReaderSlot {
+    int index = -1;
+    int depth = 0; // nested guards on this thread
+    ~ReaderSlot() {
+        if (index >= 0) processReclaimer.claimed[index].store(false);
+    }
+};
+
+thread_local ProcessReclaimer::ReaderSlot ProcessReclaimer::readerSlot;
+
+ProcessReclaimer::Guard::Guard() {
+    processReclaimer.pin();
+}
+
+ProcessReclaimer::Guard::~Guard() {
+    processReclaimer.unpin();
+}
+
+ProcessReclaimer::~ProcessReclaimer() {
+    for (const Retired& retired : limbo) delete retired.proc;
+}
+
+void ProcessReclaimer::pin() {
+    if (readerSlot.depth++ > 0) return;
+    while (readerSlot.index < 0) {
+        for (int i = 0; i < MAX_READERS; ++i) {
+            bool expected = false;
+            if (claimed[i].compare_exchange_strong(expected, true)) {
+                readerSlot.index = i;
+                break;
+            }
+        }
+        if (readerSlot.index < 0) std::this_thread::yield();
+    }
+    // Anything retired from here on was already unlinked, so this reader cannot reach it
+    readers[readerSlot.index].store(epoch.load());
+}
+
+void ProcessReclaimer::unpin() {
+    if (--readerSlot.depth > 0) return;
+    readers[readerSlot.index].store(0);
+}
+
+void ProcessReclaimer::retire(Process* proc) {
+    std::vector<Process*> freed;
+    {
+        std::lock_guard<std::mutex> lock(limboMutex);
+        limbo.push_back({ epoch.fetch_add(1), proc });
+        collect(freed);
+    }
+    for (Process* p : freed) delete p;
+}
+
+size_t ProcessReclaimer::pending() {
+    std::lock_guard<std::mutex> lock(limboMutex);
+    return limbo.size();
+}
+
+// Frees the prefix of the limbo list retired before the oldest epoch a reader still has pinned
+void ProcessReclaimer::collect(std::vector<Process*>& freed) {
+    std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+    for (int i = 0; i < MAX_READERS; ++i) {
+        std::uint64_t pinned = readers[i].load();
+        if (pinned != 0 && pinned < oldest) oldest = pinned;
+    }
+    size_t n = 0;
+    while (n < limbo.size() && limbo[n].epoch < oldest) {
+        freed.push_back(limbo[n].proc);
+        ++n;
+    }
+    limbo.erase(limbo.begin(), limbo.begin() + n);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class Process;
+
+// Epoch-based reclamation for processes that have left their scheduler. Threads that use Process
+// pointers they do not own (the console) hold a Guard meanwhile; a scheduler retires a process once
+// it is unreachable, and it is deleted when every guard that could still see it has been released.
+class ProcessReclaimer {
+public:
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    ~ProcessReclaimer();
+
+    // The caller must already have unlinked proc from everything a reader could find it through
+    void retire(Process* proc);
+    // Retired processes still waiting for readers to move on
+    size_t pending();
+
+private:
+    static const int MAX_READERS = 16;
+
+    struct Retired {
+        std::uint64_t epoch;
+        Process* proc;
+    };
+
+    struct ReaderSlot;
+    static thread_local ReaderSlot readerSlot; // this thread's claim on readers[]
+
+    void pin();
+    void unpin();
+    void collect(std::vector<Process*>& freed); // caller holds limboMutex
+
+    std::atomic<std::uint64_t> epoch{1};
+    std::atomic<std::uint64_t> readers[MAX_READERS] = {}; // epoch each reader pinned, 0 when not reading
+    std::atomic<bool> claimed[MAX_READERS] = {};
+    std::mutex limboMutex;
+    std::vector<Retired> limbo; // in retirement order, so epochs ascend
+};
+
+extern ProcessReclaimer processReclaimer;
@@ -0,0 +1,93 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+// Why a process coroutine handed its core back to the scheduler
+enum class SuspendReason {
+    Tick,      // executed one instruction, resume on the next tick
+    PageIn,    // waiting for a faulted page to arrive
+    Sleep,     // SLEEP(n): give up the core until the timer expires
+    Alu,       // batch mode: the tick's DECLARE/ADD/SUB is left for the host's BatchInterpreter
+    Finished
+};
+
+// Coroutine handle for a process's execution. The scheduler resumes it on a core once per tick;
+// the process runs until its next co_await and records why it stopped in the promise.
+class ProcessTask {
+public:
+    struct promise_type {
+        SuspendReason reason = SuspendReason::Tick;
+        int waitTicks = 0;
+
+        ProcessTask get_return_object() {
+            return ProcessTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() { reason = SuspendReason::Finished; waitTicks = 0; }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    ProcessTask() = default;
+    explicit ProcessTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    ProcessTask(ProcessTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ProcessTask& operator=(ProcessTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ProcessTask(const ProcessTask&) = delete;
+    ProcessTask& operator=(const ProcessTask&) = delete;
+    ~ProcessTask() { if (handle) handle.destroy(); }
+
+    bool valid() const { return static_cast<bool>(handle); }
+    bool done() const { return !handle || handle.done(); }
+    void resume() { if (!done()) handle.resume(); }
+    SuspendReason reason() const { return handle ? handle.promise().reason : SuspendReason::Finished; }
+    int waitTicks() const { return handle ? handle.promise().waitTicks : 0; }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Awaitables for the simulated events a process can block on
+struct NextTick {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<ProcessTask::promise_type> h) const noexcept {
+        h.promise().reason = SuspendReason::Tick;
+        h.promise().waitTicks = 0;
+    }
+    void await_resume() const noexcept {}
+};
+
+struct AluStep {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<ProcessTask::promise_type> h) const noexcept {
+        h.promise().reason = SuspendReason::Alu;
+        h.promise().waitTicks = 0;
+    }
+    void await_resume() const noexcept {}
+};
+
+struct PageIn {
+    int ticks;
+    bool await_ready() const noexcept { return ticks <= 0; }
+    void await_suspend(std::coroutine_handle<ProcessTask::promise_type> h) const noexcept {
+        h.promise().reason = SuspendReason::PageIn;
+        h.promise().waitTicks = ticks;
+    }
+    void await_resume() const noexcept {}
+};
+
+struct SleepFor {
+    int ticks;
+    bool await_ready() const noexcept { return ticks <= 0; }
+    void await_suspend(std::coroutine_handle<ProcessTask::promise_type> h) const noexcept {
+        h.promise().reason = SuspendReason::Sleep;
+        h.promise().waitTicks = ticks;
+    }
+    void await_resume() const noexcept {}
+};
@@ -0,0 +1,589 @@
+#include "Program.h"
+#include "LogSink.h"
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+
+static std::string trimmed(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\n\r");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\n\r");
+    return s.substr(start, end - start + 1);
+}
+
+static std::string stripQuotes(std::string s) {
+    if (!s.empty() && (s.front() == '"' || s.front() == '\'')) s.erase(0, 1);
+    if (!s.empty() && (s.back() == '"' || s.back() == '\'')) s.pop_back();
+    return s;
+}
+
+static bool isHexAddress(const std::string& s) {
+    if (s.size() < 3 || s[0] != '0' || (s[1] != 'x' && s[1] != 'X')) return false;
+    for (size_t i = 2; i < s.size(); ++i) {
+        if (!std::isxdigit(static_cast<unsigned char>(s[i]))) return false;
+    }
+    return s.size() <= 6;
+}
+
+static std::uint16_t parseAddress(const std::string& s) {
+    return static_cast<std::uint16_t>(std::stoul(s, nullptr, 16));
+}
+
+bool Program::isVar(const std::string& s) {
+    if (s.empty()) return false;
+
+    // First character must be a letter or underscore
+    if (!std::isalpha(static_cast<unsigned char>(s[0])) && s[0] != '_') return false;
+
+    // Remaining characters can be alphanumeric or underscore
+    for (size_t i = 1; i < s.length(); ++i) {
+        if (!std::isalnum(static_cast<unsigned char>(s[i])) && s[i] != '_') return false;
+    }
+    return true;
+}
+
+bool Program::isVal(const std::string& s) {
+    if (s.empty()) return false;
+
+    size_t i = 0;
+    if (s[0] == '-' || s[0] == '+') i = 1;
+    if (i == s.size()) return false;
+
+    for (; i < s.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(s[i]))) return false;
+    }
+    return true;
+}
+
+bool Program::isMemAdd(const std::string& s) {
+    static const std::unordered_set<std::string> validAddresses = {
+        "0x100", "0x200", "0x300", "0x400", "0x500",
+        "0x600", "0x700", "0x800", "0x900", "0x1000"
+    };
+    return validAddresses.count(s) > 0;
+}
+
+// Slot of a variable, declaring it on first use; -1 once the symbol table is full
+int Program::slotFor(const std::string& name) {
+    for (size_t i = 0; i < varNames.size(); ++i) {
+        if (varNames[i] == name) return static_cast<int>(i);
+    }
+    if (static_cast<int>(varNames.size()) >= MAX_VARIABLES) return -1;
+    varNames.push_back(name);
+    return static_cast<int>(varNames.size() - 1);
+}
+
+// Identical messages share one string
+void Program::setString(Op& op, const std::string& s) {
+    auto it = stringIndex.find(s);
+    std::uint32_t index;
+    if (it != stringIndex.end()) {
+        index = it->second;
+    } else {
+        index = static_cast<std::uint32_t>(strings.size());
+        strings.push_back(s);
+        stringIndex.emplace(s, index);
+    }
+    op.setWide(index);
+}
+
+// Resolves an ADD/SUB/WRITE source operand to a variable slot or an immediate
+bool Program::source(const std::string& token, std::uint16_t& out, bool& immediate) {
+    if (isVal(token)) {
+        out = static_cast<std::uint16_t>(std::stoi(token));
+        immediate = true;
+        return true;
+    }
+    if (isVar(token)) {
+        int slot = slotFor(token);
+        if (slot < 0) return false;
+        out = static_cast<std::uint16_t>(slot);
+        immediate = false;
+        return true;
+    }
+    return false;
+}
+
+// userProgram: screen -c rules (fixed address set, WRITE takes a variable, PRINT needs "msg" + var)
+bool Program::emit(const std::vector<std::string>& t, bool userProgram) {
+    if (t.empty()) return false;
+    const std::string& name = t[0];
+    Op op;
+    bool immB = false, immC = false;
+
+    if (name == "DECLARE" && t.size() == 3 && isVar(t[1]) && isVal(t[2])) {
+        int slot = slotFor(t[1]);
+        if (slot < 0) {
+            // Symbol table full: the declaration is ignored but keeps its line
+            setString(op, "DECLARE(" + t[1] + ", " + t[2] + ")");
+        } else {
+            op.code = OpCode::Declare;
+            op.a = static_cast<std::uint16_t>(slot);
+            op.b = static_cast<std::uint16_t>(std::stoi(t[2]));
+        }
+    }
+    else if ((name == "ADD" || name == "SUB" || name == "SUBTRACT") && t.size() == 4 && isVar(t[1])
+             && (isVar(t[2]) || isVal(t[2])) && (isVar(t[3]) || isVal(t[3]))) {
+        std::uint16_t b, c;
+        int slot = slotFor(t[1]);
+        if (slot < 0 || !source(t[2], b, immB) || !source(t[3], c, immC)) return false;
+        op.code = name == "ADD" ? OpCode::Add : OpCode::Sub;
+        op.a = static_cast<std::uint16_t>(slot);
+        op.b = b;
+        op.c = c;
+    }
+    else if (name == "WRITE" && t.size() == 3) {
+        if (userProgram ? !isMemAdd(t[1]) || !isVar(t[2]) : !isHexAddress(t[1])) return false;
+        std::uint16_t b;
+        if (!source(t[2], b, immB)) return false;
+        op.code = OpCode::Write;
+        op.a = parseAddress(t[1]);
+        op.b = b;
+    }
+    else if (name == "READ" && t.size() == 3 && isVar(t[1])) {
+        if (userProgram ? !isMemAdd(t[2]) : !isHexAddress(t[2])) return false;
+        int slot = slotFor(t[1]);
+        if (slot < 0) return false;
+        op.code = OpCode::Read;
+        op.a = static_cast<std::uint16_t>(slot);
+        op.b = parseAddress(t[2]);
+    }
+    else if (name == "PRINT" && t.size() == 4 && t[2] == "+" && isVar(t[3])) {
+        int slot = slotFor(t[3]);
+        if (slot < 0) return false;
+        op.code = OpCode::Print;
+        op.flags = Op::HAS_VAR;
+        op.a = static_cast<std::uint16_t>(slot);
+        setString(op, stripQuotes(t[1]));
+    }
+    else if (name == "PRINT" && t.size() == 2 && !userProgram) {
+        op.code = OpCode::Print;
+        setString(op, stripQuotes(t[1]));
+    }
+    else if (name == "SLEEP" && t.size() == 2 && isVal(t[1])) {
+        op.code = OpCode::Sleep;
+        op.b = static_cast<std::uint16_t>(std::stoi(t[1]));
+    }
+    else {
+        return false;
+    }
+
+    if (immB) op.flags |= Op::IMM_B;
+    if (immC) op.flags |= Op::IMM_C;
+    append(op);
+    return true;
+}
+
+void Program::compileLine(const std::string& text) {
+    compileText(text, 0);
+}
+
+// Emits one instruction, or a FOR with its whole body
+void Program::compileText(const std::string& text, int depth) {
+    std::string s = trimmed(text);
+    std::vector<std::string> tokens;
+
+    size_t open = s.find('(');
+    if (s.rfind("FOR(", 0) == 0 && depth < MAX_LOOP_DEPTH) {
+        // FOR([body; ...], count): the body sits between the header and its EndFor
+        size_t bodyStart = s.find('[');
+        size_t i = bodyStart == std::string::npos ? s.size() : bodyStart + 1;
+        int brackets = 1;
+        size_t bodyEnd = i;
+        for (; i < s.size() && brackets > 0; ++i) {
+            if (s[i] == '[') brackets++;
+            else if (s[i] == ']') brackets--;
+            bodyEnd = i;
+        }
+        size_t comma = s.find(',', bodyEnd);
+        if (bodyStart != std::string::npos && brackets == 0 && comma != std::string::npos && isVal(trimmed(s.substr(comma + 1, s.rfind(')') - comma - 1)))) {
+            int count = std::stoi(trimmed(s.substr(comma + 1, s.rfind(')') - comma - 1)));
+            std::uint32_t header = beginLoop(static_cast<std::uint16_t>(std::clamp(count, 0, 0xFFFF)));
+
+            // Split the body on top-level ';'
+            std::string body = s.substr(bodyStart + 1, bodyEnd - bodyStart - 1);
+            int nested = 0;
+            size_t from = 0;
+            for (size_t j = 0; j <= body.size(); ++j) {
+                if (j < body.size() && body[j] == '[') nested++;
+                else if (j < body.size() && body[j] == ']') nested--;
+                else if (j == body.size() || (body[j] == ';' && nested == 0)) {
+                    compileText(body.substr(from, j - from), depth + 1);
+                    from = j + 1;
+                }
+            }
+
+            endLoop(header);
+            return;
+        }
+    } else if (open == std::string::npos) {
+        std::istringstream words(s);
+        std::string word;
+        while (words >> word) tokens.push_back(word);
+    } else {
+        tokens.push_back(trimmed(s.substr(0, open)));
+        size_t close = s.rfind(')');
+        if (close == std::string::npos || close < open) close = s.size();
+        std::string inner = s.substr(open + 1, close - open - 1);
+
+        if (tokens[0] == "PRINT") {
+            size_t plus = inner.rfind('+');
+            if (plus != std::string::npos && isVar(trimmed(inner.substr(plus + 1)))) {
+                tokens.push_back(trimmed(inner.substr(0, plus)));
+                tokens.push_back("+");
+                tokens.push_back(trimmed(inner.substr(plus + 1)));
+            } else {
+                tokens.push_back(trimmed(inner));
+            }
+        } else {
+            std::stringstream args(inner);
+            std::string arg;
+            while (std::getline(args, arg, ',')) tokens.push_back(trimmed(arg));
+        }
+    }
+
+    if (!emit(tokens, false)) appendNop(s);
+}
+
+void Program::appendNop(const std::string& text) {
+    Op nop;
+    setString(nop, text);
+    append(nop);
+}
+
+void Program::appendPrint(const std::string& message) {
+    Op op;
+    op.code = OpCode::Print;
+    setString(op, message);
+    append(op);
+}
+
+std::uint32_t Program::sizeOf(const Op& op) {
+    switch (op.code) {
+    case OpCode::Declare: return 2;
+    case OpCode::Add:
+    case OpCode::Sub:
+    case OpCode::Read: return 3;
+    case OpCode::Write: return 2;
+    case OpCode::EndFor: return 0;
+    case OpCode::PrintRun: return op.a;
+    case OpCode::Nop:
+    case OpCode::Print:
+    case OpCode::Sleep:
+    case OpCode::For: return 1;
+    }
+    return 1;
+}
+
+// The header counts as one instruction; endLoop scales the body by the iteration count
+std::uint32_t Program::beginLoop(std::uint16_t count) {
+    openLoops.push_back({ executed, bytes });
+    Op op;
+    op.code = OpCode::For;
+    op.a = count;
+    append(op);
+    return static_cast<std::uint32_t>(code.size() - 1);
+}
+
+void Program::endLoop(std::uint32_t header) {
+    OpenLoop start = openLoops.back();
+    openLoops.pop_back();
+    std::uint64_t body = executed - start.executed - 1;
+    executed = start.executed + 1 + code[header].a * body;
+    std::uint64_t bodyBytes = bytes - start.bytes - sizeOf(code[header]);
+    bytes = start.bytes + sizeOf(code[header]) + code[header].a * bodyBytes;
+
+    Op end;
+    end.code = OpCode::EndFor;
+    end.setWide(header);
+    code[header].setWide(static_cast<std::uint32_t>(code.size()));
+    code.push_back(end);
+}
+
+bool Program::compileTokens(const std::vector<std::string>& tokens) {
+    return emit(tokens, true);
+}
+
+std::string Program::operandText(std::uint16_t value, bool immediate) const {
+    return immediate ? std::to_string(value) : varNames[value];
+}
+
+static std::string hexAddress(std::uint16_t address) {
+    std::ostringstream oss;
+    oss << "0x" << std::hex << address;
+    return oss.str();
+}
+
+std::string Program::disassemble(size_t pc) const {
+    const Op& op = code[pc];
+    switch (op.code) {
+    case OpCode::Nop:
+        return stringOf(op);
+    case OpCode::Declare:
+        return "DECLARE(" + varNames[op.a] + ", " + std::to_string(op.b) + ")";
+    case OpCode::Add:
+    case OpCode::Sub:
+        return std::string(op.code == OpCode::Add ? "ADD(" : "SUB(") + varNames[op.a] + ", "
+            + operandText(op.b, op.flags & Op::IMM_B) + ", " + operandText(op.c, op.flags & Op::IMM_C) + ")";
+    case OpCode::Write:
+        return "WRITE " + hexAddress(op.a) + " " + operandText(op.b, op.flags & Op::IMM_B);
+    case OpCode::Read:
+        return "READ " + varNames[op.a] + " " + hexAddress(op.b);
+    case OpCode::Print:
+        if (op.flags & Op::HAS_VAR) return "PRINT(\"" + stringOf(op) + "\" + " + varNames[op.a] + ")";
+        return "PRINT(\"" + stringOf(op) + "\")";
+    case OpCode::Sleep:
+        return "SLEEP(" + std::to_string(op.b) + ")";
+    case OpCode::For: {
+        std::string body;
+        for (size_t i = pc + 1; i < op.wide(); ++i) {
+            if (!body.empty()) body += "; ";
+            body += disassemble(i);
+            if (code[i].code == OpCode::For) i = code[i].wide();
+        }
+        return "FOR([" + body + "], " + std::to_string(op.a) + ")";
+    }
+    case OpCode::EndFor:
+        return "END FOR";
+    case OpCode::PrintRun:
+        return "PRINT(\"" + stringOf(op) + "\") x" + std::to_string(op.a);
+    }
+    return "";
+}
+
+// Works on straight-line runs: the ops between two loop markers. Nothing is moved across a For
+// or EndFor, so an op that absorbs another's lines always executes exactly as often as it did.
+void Program::optimize() {
+    if (!openLoops.empty()) return;
+
+    struct Reg {
+        bool known = false;   // constant value at this point of the run
+        std::uint16_t value = 0;
+        long store = -1;      // op that last wrote it, while nothing has read it since
+    };
+    Reg regs[MAX_VARIABLES];
+    std::vector<Op> out;
+    std::vector<std::uint32_t> outWeights;
+    std::vector<bool> dead;
+    std::size_t runStart = 0;
+    std::uint32_t pending = 0; // lines of dropped Nops, credited to the next op kept
+
+    auto resetRun = [&] {
+        for (Reg& r : regs) r = Reg();
+        runStart = out.size();
+    };
+    auto emit = [&](const Op& op, std::uint32_t w) {
+        out.push_back(op);
+        outWeights.push_back(w);
+        dead.push_back(false);
+    };
+    // A run that ends with lines still pending gives them to its last op, or keeps one Nop
+    auto flushRun = [&] {
+        if (pending == 0) return;
+        if (out.size() > runStart) {
+            outWeights.back() += pending;
+        } else {
+            Op nop;
+            setString(nop, "");
+            emit(nop, pending);
+        }
+        pending = 0;
+    };
+    auto readReg = [&](std::uint16_t r) { regs[r].store = -1; };
+    auto foldOperand = [&](std::uint16_t& operand, std::uint8_t& flags, std::uint8_t imm) {
+        if (!(flags & imm) && regs[operand].known) {
+            operand = regs[operand].value;
+            flags |= imm;
+        }
+    };
+
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        Op op = code[i];
+        std::uint32_t w = weightOf(i);
+
+        if (op.code == OpCode::For) {
+            emit(op, w + pending);
+            pending = 0;
+            resetRun();
+            continue;
+        }
+        if (op.code == OpCode::EndFor) {
+            flushRun();
+            emit(op, w);
+            resetRun();
+            continue;
+        }
+        if (op.code == OpCode::Nop) {
+            pending += w;
+            continue;
+        }
+        w += pending;
+        pending = 0;
+
+        switch (op.code) {
+        case OpCode::Add:
+        case OpCode::Sub:
+            foldOperand(op.b, op.flags, Op::IMM_B);
+            foldOperand(op.c, op.flags, Op::IMM_C);
+            if ((op.flags & Op::IMM_B) && (op.flags & Op::IMM_C)) {
+                std::uint16_t value = op.code == OpCode::Add ? op.b + op.c : op.b - op.c;
+                op = Op();
+                op.code = OpCode::Declare;
+                op.a = code[i].a;
+                op.b = value;
+            } else {
+                if (!(op.flags & Op::IMM_B)) readReg(op.b);
+                if (!(op.flags & Op::IMM_C)) readReg(op.c);
+            }
+            break;
+        case OpCode::Write:
+            foldOperand(op.b, op.flags, Op::IMM_B);
+            if (!(op.flags & Op::IMM_B)) readReg(op.b);
+            break;
+        case OpCode::Print:
+            if (op.flags & Op::HAS_VAR) {
+                readReg(op.a);
+            } else if (out.size() > runStart && !dead.back() && out.back().wide() == op.wide()
+                       && (out.back().code == OpCode::PrintRun
+                           || (out.back().code == OpCode::Print && !(out.back().flags & Op::HAS_VAR)))) {
+                // Superinstruction: consecutive identical messages become one PrintRun
+                Op& run = out.back();
+                if (run.code == OpCode::Print) {
+                    run.code = OpCode::PrintRun;
+                    run.a = 1;
+                }
+                if (run.a < 0xFFFF) {
+                    run.a++;
+                    outWeights.back() += w;
+                    continue;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+
+        // Register writes: an unread earlier store to the same register is dead
+        if (op.code == OpCode::Declare || op.code == OpCode::Add || op.code == OpCode::Sub || op.code == OpCode::Read) {
+            Reg& r = regs[op.a];
+            if (r.store >= 0) {
+                dead[r.store] = true;
+                w += outWeights[r.store];
+            }
+            r.known = op.code == OpCode::Declare;
+            r.value = op.b;
+            // READ also touches memory, so it is never dropped itself
+            r.store = op.code == OpCode::Read ? -1 : static_cast<long>(out.size());
+        }
+        emit(op, w);
+    }
+    flushRun();
+
+    // Compact and re-link the loops
+    code.clear();
+    weights.clear();
+    std::vector<std::uint32_t> headers;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        if (dead[i]) continue;
+        Op op = out[i];
+        if (op.code == OpCode::For) {
+            headers.push_back(static_cast<std::uint32_t>(code.size()));
+        } else if (op.code == OpCode::EndFor) {
+            std::uint32_t header = headers.back();
+            headers.pop_back();
+            op.setWide(header);
+            code[header].setWide(static_cast<std::uint32_t>(code.size()));
+        }
+        code.push_back(op);
+        weights.push_back(outWeights[i]);
+    }
+}
+
+// FNV-1a over the ops, the string table and the symbol names
+std::uint64_t Program::contentHash() const {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    auto mix = [&h](const void* data, std::size_t len) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < len; ++i) {
+            h ^= bytes[i];
+            h *= 0x100000001b3ull;
+        }
+    };
+    mix(weights.data(), weights.size() * sizeof(std::uint32_t));
+    for (const Op& op : code) {
+        const std::uint8_t head[2] = { static_cast<std::uint8_t>(op.code), op.flags };
+        mix(head, sizeof(head));
+        mix(&op.a, sizeof(op.a));
+        mix(&op.b, sizeof(op.b));
+        mix(&op.c, sizeof(op.c));
+    }
+    for (const std::string& s : strings) mix(s.c_str(), s.size() + 1);
+    for (const std::string& s : varNames) mix(s.c_str(), s.size() + 1);
+    mix(&executed, sizeof(executed));
+    mix(&bytes, sizeof(bytes));
+    return h;
+}
+
+bool Program::sameContent(const Program& other) const {
+    if (executed != other.executed || bytes != other.bytes || code.size() != other.code.size()
+        || weights != other.weights || strings != other.strings || varNames != other.varNames) {
+        return false;
+    }
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        const Op& x = code[i];
+        const Op& y = other.code[i];
+        if (x.code != y.code || x.flags != y.flags || x.a != y.a || x.b != y.b || x.c != y.c) return false;
+    }
+    return true;
+}
+
+void Program::bindLogFormats() {
+    for (std::size_t i = formatIds.size(); i < strings.size(); ++i) {
+        formatIds.push_back(logSink.formatId(strings[i]));
+    }
+}
+
+static std::mutex imagesMutex;
+static std::unordered_multimap<std::uint64_t, std::weak_ptr<const Program>> images;
+static std::size_t sweepAt = 1024;
+
+std::shared_ptr<const Program> Program::intern(Program&& program) {
+    // Build-time state is not needed once the program is frozen
+    program.stringIndex = {};
+    program.openLoops = {};
+    program.code.shrink_to_fit();
+    program.strings.shrink_to_fit();
+    program.formatIds.shrink_to_fit();
+    std::uint64_t hash = program.contentHash();
+
+    std::lock_guard<std::mutex> lock(imagesMutex);
+    auto range = images.equal_range(hash);
+    for (auto it = range.first; it != range.second;) {
+        std::shared_ptr<const Program> image = it->second.lock();
+        if (!image) {
+            it = images.erase(it);
+            continue;
+        }
+        if (image->sameContent(program)) return image;
+        ++it;
+    }
+
+    // Sweep expired entries now and then so the table tracks the live images
+    if (images.size() >= sweepAt) {
+        for (auto it = images.begin(); it != images.end();) {
+            it = it->second.expired() ? images.erase(it) : std::next(it);
+        }
+        sweepAt = std::max<std::size_t>(1024, images.size() * 2);
+    }
+
+    auto image = std::make_shared<const Program>(std::move(program));
+    images.emplace(hash, image);
+    return image;
+}
+
+const std::shared_ptr<const Program>& Program::emptyImage() {
+    static const std::shared_ptr<const Program> empty = std::make_shared<const Program>();
+    return empty;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Instruction set the process interpreter runs. Names, immediates and addresses are resolved
+// when the program is built, so executing an instruction never touches a string.
+enum class OpCode : std::uint8_t {
+    Nop,      // line with no runtime effect; text in strings[b:c]
+    Declare,  // var[a] = b
+    Add,      // var[a] = B + C
+    Sub,      // var[a] = B - C
+    Write,    // mem[a] = B
+    Read,     // var[a] = mem[b]
+    Print,    // log strings[b:c], followed by var[a] when HAS_VAR is set
+    Sleep,    // give up the core for b ticks
+    For,      // run the body up to the matching EndFor (at index b:c) a times
+    EndFor,   // loop back to the For at index b:c; bookkeeping only, never takes a tick
+    PrintRun, // log strings[b:c] a times (only produced by optimize)
+};
+
+// One instruction packed into 8 bytes. B and C are variable slots unless their IMM flag is set.
+struct Op {
+    static const std::uint8_t IMM_B = 1;
+    static const std::uint8_t IMM_C = 2;
+    static const std::uint8_t HAS_VAR = 4;
+
+    OpCode code = OpCode::Nop;
+    std::uint8_t flags = 0;
+    std::uint16_t a = 0;
+    std::uint16_t b = 0;
+    std::uint16_t c = 0;
+
+    // 32-bit operand split across b (low) and c (high): string and jump indices
+    std::uint32_t wide() const { return b | (std::uint32_t(c) << 16); }
+    void setWide(std::uint32_t value) {
+        b = static_cast<std::uint16_t>(value & 0xFFFF);
+        c = static_cast<std::uint16_t>(value >> 16);
+    }
+};
+static_assert(sizeof(Op) == 8, "Op should stay a single 8-byte word");
+
+class Program {
+public:
+    // Size of a process's symbol table; once it is full, new DECLAREs are ignored
+    static const int MAX_VARIABLES = 32;
+    // Deepest FOR nesting a process's loop stack holds
+    static const int MAX_LOOP_DEPTH = 3;
+
+    // Generated instruction text, e.g. "ADD(var1, 5, var2)", "READ var3 0x4a" or "FOR([...], 2)".
+    // Anything that does not parse still takes a line, as a Nop.
+    void compileLine(const std::string& text);
+    // One tokenized screen -c command, e.g. {"ADD", "x", "x", "1"}; false if it is malformed
+    bool compileTokens(const std::vector<std::string>& tokens);
+
+    // Direct emission, used by ProgramGenerator to skip the text round trip
+    void append(const Op& op) { code.push_back(op); executed++; bytes += sizeOf(op); }
+    void appendNop(const std::string& text);
+    void appendPrint(const std::string& message);
+    std::uint32_t beginLoop(std::uint16_t count);
+    void endLoop(std::uint32_t header);
+    // Slot of a variable, declaring it on first use; -1 once the symbol table is full
+    int variableSlot(const std::string& name) { return slotFor(name); }
+    // Drops the ops but keeps the symbol table, strings, executed count and byte size (lazy generation window)
+    void clearCode() { code.clear(); weights.clear(); }
+    // Peephole pass: constant folding, dead-store elimination and PRINT runs. Registers and the
+    // PRINT log end up as without it; dropped lines are credited to a surviving op via weightOf.
+    void optimize();
+
+    std::size_t size() const { return code.size(); }
+    // Instructions a full run executes: FOR headers once per entry, bodies once per iteration
+    std::uint64_t executedLength() const { return executed; }
+    // Memory the source instructions take, counted like executedLength (FOR bodies once per iteration)
+    std::uint64_t byteSize() const { return bytes; }
+    // Bytes of one op on its own; a For is just its header
+    static std::uint32_t sizeOf(const Op& op);
+    // The ops in place; valid until the program holding them is replaced
+    std::span<const Op> ops() const { return code; }
+    const Op& at(std::size_t pc) const { return code[pc]; }
+    // Source instructions the op at pc stands for; 1 unless the program was optimized
+    std::uint32_t weightOf(std::size_t pc) const { return weights.empty() ? 1 : weights[pc]; }
+    // PRINT message or Nop text
+    const std::string& stringOf(const Op& op) const { return strings[op.wide()]; }
+    // LogSink format id of the same string, once bindLogFormats has run
+    std::uint32_t formatOf(const Op& op) const { return formatIds[op.wide()]; }
+    // Registers any strings added since the last call with the log sink
+    void bindLogFormats();
+    std::size_t numVariables() const { return varNames.size(); }
+    // Source form of one instruction, for logs and screen output
+    std::string disassemble(std::size_t pc) const;
+
+    static bool isVar(const std::string& s);
+    static bool isVal(const std::string& s);
+    static bool isMemAdd(const std::string& s);
+
+    // Freezes a finished program into a shared image. Programs with the same content get the
+    // same image; an image is dropped once the last process holding it goes away.
+    static std::shared_ptr<const Program> intern(Program&& program);
+    // Image with no instructions, held by processes that have not been given a program yet
+    static const std::shared_ptr<const Program>& emptyImage();
+
+private:
+    std::uint64_t contentHash() const;
+    bool sameContent(const Program& other) const;
+
+    void compileText(const std::string& text, int depth);
+    bool emit(const std::vector<std::string>& tokens, bool userProgram);
+    bool source(const std::string& token, std::uint16_t& out, bool& immediate);
+    int slotFor(const std::string& name);
+    void setString(Op& op, const std::string& s);
+    std::string operandText(std::uint16_t value, bool immediate) const;
+
+    std::vector<Op> code;
+    std::vector<std::uint32_t> weights; // per-op line counts after optimize, empty before
+    std::uint64_t executed = 0;
+    std::uint64_t bytes = 0;
+    struct OpenLoop {
+        std::uint64_t executed; // counts when the loop began
+        std::uint64_t bytes;
+    };
+    std::vector<OpenLoop> openLoops; // unfinished loops, innermost last
+    std::vector<std::string> strings;  // PRINT messages and raw Nop text
+    std::unordered_map<std::string, std::uint32_t> stringIndex;
+    std::vector<std::uint32_t> formatIds; // strings[i] -> LogSink format id
+    std::vector<std::string> varNames; // slot -> name, at most MAX_VARIABLES
+};
@@ -0,0 +1,113 @@
+#include "ProgramGenerator.h"
+#include <string>
+
+ProgramGenerator::ProgramGenerator(std::uint64_t seed, int totalInstructions, int memSize)
+    : seed(seed), rng(seed), remaining(totalInstructions), memSize(memSize) {}
+
+int ProgramGenerator::slotOf(Program& program, int var) {
+    usedVars |= 1u << (var - 1);
+    return program.variableSlot("var" + std::to_string(var));
+}
+
+// Even address inside the process's memory, starting at 0x40
+int ProgramGenerator::randomAddress() {
+    int baseAddr = 0x0040;
+    int maxEvenAddr = baseAddr + memSize - 2; // Exclude the last even address
+    if (maxEvenAddr < baseAddr) return baseAddr;
+    int numEvenAddrs = ((maxEvenAddr - baseAddr) / 2) + 1;
+    return baseAddr + randomInt(0, numEvenAddrs - 1) * 2;
+}
+
+void ProgramGenerator::generate(Program& program, int count) {
+    for (; count > 0 && remaining > 0; --count, --remaining) {
+        generateInstruction(program, 0);
+    }
+}
+
+void ProgramGenerator::generateInstruction(Program& program, int nestingLevel) {
+    enum { PRINT, DECLARE, ADD, SUBTRACT, SLEEP, FOR, READ, WRITE };
+    int type = randomInt(PRINT, WRITE);
+    Op op;
+
+    switch (type) {
+    case PRINT:
+        program.appendPrint("Hello world from process!");
+        return;
+
+    case DECLARE: {
+        // First undeclared variable in ascending order
+        int next = 1;
+        while (next <= 32 && (usedVars & (1u << (next - 1)))) next++;
+        if (next > 32) break; // All variables already declared
+        op.code = OpCode::Declare;
+        op.a = static_cast<std::uint16_t>(slotOf(program, next));
+        op.b = static_cast<std::uint16_t>(randomInt(0, 65535));
+        program.append(op);
+        return;
+    }
+
+    case ADD:
+    case SUBTRACT: {
+        int target = randomInt(1, 32);
+        int src1 = randomInt(1, 32);
+        int src2 = randomInt(1, 32);
+        op.code = type == ADD ? OpCode::Add : OpCode::Sub;
+        op.a = static_cast<std::uint16_t>(slotOf(program, target));
+        if (randomInt(0, 1) == 0) {
+            op.flags |= Op::IMM_B;
+            op.b = static_cast<std::uint16_t>(randomInt(0, 100));
+        } else {
+            op.b = static_cast<std::uint16_t>(slotOf(program, src1));
+        }
+        if (randomInt(0, 1) == 0) {
+            op.flags |= Op::IMM_C;
+            op.c = static_cast<std::uint16_t>(randomInt(0, 100));
+        } else {
+            op.c = static_cast<std::uint16_t>(slotOf(program, src2));
+        }
+        program.append(op);
+        return;
+    }
+
+    case SLEEP:
+        op.code = OpCode::Sleep;
+        op.b = static_cast<std::uint16_t>(randomInt(1, 50));
+        program.append(op);
+        return;
+
+    case FOR: {
+        if (nestingLevel >= MAX_NESTING) break;
+        std::uint32_t header = program.beginLoop(static_cast<std::uint16_t>(randomInt(1, 3)));
+        generateInstruction(program, nestingLevel + 1);
+        program.endLoop(header);
+        return;
+    }
+
+    case READ: {
+        if (usedVars == 0) break; // Nothing declared to read into yet
+        int declared = 0;
+        for (std::uint32_t bits = usedVars; bits; bits &= bits - 1) declared++;
+        int pick = randomInt(0, declared - 1);
+        int var = 1;
+        for (; var <= 32; ++var) {
+            if ((usedVars & (1u << (var - 1))) && pick-- == 0) break;
+        }
+        op.code = OpCode::Read;
+        op.a = static_cast<std::uint16_t>(slotOf(program, var));
+        op.b = static_cast<std::uint16_t>(randomAddress());
+        program.append(op);
+        return;
+    }
+
+    case WRITE:
+        op.code = OpCode::Write;
+        op.flags = Op::IMM_B;
+        op.a = static_cast<std::uint16_t>(randomAddress());
+        op.b = static_cast<std::uint16_t>(randomInt(0, 65535));
+        program.append(op);
+        return;
+    }
+
+    // Skipped instructions still take their line
+    program.appendNop("");
+}
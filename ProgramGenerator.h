@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include "Program.h"
+
+// Small-state RNG (splitmix64). One per process or per generator, so no stream is shared across threads.
+struct SplitMix64 {
+    std::uint64_t state = 0;
+
+    explicit SplitMix64(std::uint64_t seed = 0) : state(seed) {}
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // Uniform enough for instruction mixes: [min, max]
+    int range(int min, int max) {
+        return min + static_cast<int>(next() % static_cast<std::uint64_t>(max - min + 1));
+    }
+    // Independent stream for one process: the same (seed, pid) always gives the same numbers
+    static std::uint64_t streamSeed(std::uint64_t seed, std::uint64_t pid) {
+        SplitMix64 mix(seed ^ (pid * 0xD1B54A32D192ED03ull));
+        return mix.next();
+    }
+};
+
+// Deterministic random program source for auto-generated processes. The whole state is a seed,
+// the RNG position and a cursor, so a program can be produced a chunk at a time as it runs;
+// the same seed, length and memory size always give the same instruction stream.
+class ProgramGenerator {
+public:
+    ProgramGenerator() = default;
+    ProgramGenerator(std::uint64_t seed, int totalInstructions, int memSize);
+
+    // Appends up to `count` top-level instructions (a FOR with its whole body counts as one)
+    void generate(Program& program, int count);
+    int getRemaining() const { return remaining; }
+    bool done() const { return remaining == 0; }
+    std::uint64_t getSeed() const { return seed; }
+
+private:
+    void generateInstruction(Program& program, int nestingLevel);
+    int slotOf(Program& program, int var);
+    int randomAddress();
+    int randomInt(int min, int max) { return rng.range(min, max); }
+
+    static const int MAX_NESTING = Program::MAX_LOOP_DEPTH;
+
+    std::uint64_t seed = 0;
+    SplitMix64 rng;
+    int remaining = 0;
+    int memSize = 0;
+    std::uint32_t usedVars = 0; // bit i set once var(i+1) has been declared or used
+};
@@ -22,10 +22,57 @@ extern int min_mem_per_proc;
 extern int max_mem_per_proc;
 extern int max_overall_mem;
 extern int mem_per_frame;
+extern int default_weight;
+extern int page_fault_ticks;
+extern std::string program_generation;
+extern std::string execution_mode;
+extern int ticks_per_step;
+extern std::uint64_t random_seed;
+extern int generator_threads;
+extern int batch_process_size;
+extern int archive_size;
+extern int migration_cost;
+extern int balance_interval;
+extern int balance_threshold;
+
+namespace {
+
+// Wall-clock length of one scheduler tick for idle accounting and process generation
+const std::chrono::milliseconds TICK_DURATION(1);
+
+// Simulated time one instruction takes on a core (to catch 100% or 0% cpu utilization)
+const std::chrono::milliseconds INSTRUCTION_TICK(1000);
+
+std::chrono::steady_clock::time_point toTimePoint(int64_t rep) {
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(rep));
+}
+
+// 0 means "not idle"
+int ticksSince(int64_t since) {
+    if (since == 0) return 0;
+    return static_cast<int>((std::chrono::steady_clock::now() - toTimePoint(since)) / TICK_DURATION);
+}
+
+} // namespace
+
+// A tick of CPU time at nice-0 weight advances vruntime by this much
+static const uint64_t NICE_0_WEIGHT = 1024;
+static const uint64_t VRUNTIME_PER_TICK = 1024;
 
 RRScheduler::RRScheduler(int numCores, int quantumCycles)
-    : numCores(numCores), quantumCycles(quantumCycles), running(false), processGenActive(false), cpuCycles(0), idleTicks(0), activeTicks(0) {
+    : numCores(numCores), quantumCycles(quantumCycles), idleCores(numCores), runningSlots(new std::atomic<Process*>[numCores]),
+      idleSince(new std::atomic<int64_t>[numCores]), cpuCycles(0), running(false), processGenActive(false), activeTicks(0), idleTicks(0) {
+    for (int c = 0; c < numCores; ++c) {
+        runningSlots[c].store(nullptr);
+        idleSince[c].store(0);
+    }
+    cores.assign(numCores, CoreState());
+    finishedProcesses.setCapacity(static_cast<size_t>(archive_size));
     memoryManager = new MemoryManager(max_overall_mem, max_mem_per_proc, mem_per_frame);
+    runQueues.resize(numCores);
+    migrationCost = migration_cost;
+    balanceInterval = balance_interval;
+    balanceThreshold = balance_threshold;
 }
 
 RRScheduler::~RRScheduler() {
@@ -34,27 +81,227 @@ RRScheduler::~RRScheduler() {
 
 void RRScheduler::addProcess(Process* proc) {
     std::lock_guard<std::mutex> lock(queueMutex);
-    readyProcesses.push_back(proc);
-    readyQueue.push(proc);
-    cv.notify_all();
+    proc->transition(ProcessState::Ready, currentTick());
+    proc->recordArrival(proc->getStateEnteredAt(ProcessState::Ready));
+    index.insert(proc);
+    logSink.registerProcess(static_cast<std::uint32_t>(proc->getPid()), proc->getName());
+    int core = selectCore();
+    attachToCore(core, proc);
+    // Wake the target core if it is parked, otherwise an idle core that can steal the work
+    wakeCore(idleCores.isIdle(core) ? core : idleCores.findIdle());
+}
+
+void RRScheduler::setFairScheduling(int latency, int granularity) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    fairMode = true;
+    targetLatency = latency > 0 ? latency : quantumCycles.load();
+    minGranularity = granularity > 0 ? granularity : 1;
+}
+
+// Caller must hold queueMutex
+void RRScheduler::enqueueOn(int core, Process* proc) {
+    RunQueue& rq = runQueues[core];
+    if (!fairMode) {
+        rq.fifo.push_back(proc);
+        return;
+    }
+    // New or long-waiting processes start at the current minimum so they cannot starve the rest
+    if (proc->getVruntime() < minVruntime) {
+        proc->setVruntime(minVruntime);
+    }
+    rq.tree.emplace(proc->getVruntime(), proc);
+}
+
+// Caller must hold queueMutex
+Process* RRScheduler::dequeueFrom(int core) {
+    RunQueue& rq = runQueues[core];
+    if (!fairMode) {
+        Process* proc = rq.fifo.front();
+        rq.fifo.pop_front();
+        return proc;
+    }
+    auto it = rq.tree.begin();
+    Process* proc = it->second;
+    minVruntime = std::max(minVruntime, it->first);
+    rq.tree.erase(it);
+    return proc;
+}
+
+// Takes the process least likely to run soon, used when migrating work away from a core
+Process* RRScheduler::detachTail(int core) {
+    RunQueue& rq = runQueues[core];
+    Process* proc = nullptr;
+    if (!fairMode) {
+        proc = rq.fifo.back();
+        rq.fifo.pop_back();
+    } else {
+        auto it = std::prev(rq.tree.end());
+        proc = it->second;
+        rq.tree.erase(it);
+    }
+    rq.weight -= proc->getWeight();
+    return proc;
+}
+
+void RRScheduler::attachToCore(int core, Process* proc) {
+    runQueues[core].weight += proc->getWeight();
+    enqueueOn(core, proc);
+}
+
+int RRScheduler::queuedOn(int core) const {
+    const RunQueue& rq = runQueues[core];
+    return static_cast<int>(fairMode ? rq.tree.size() : rq.fifo.size());
+}
+
+// Queued processes plus the one on the core, if any
+int RRScheduler::coreLoad(int core) const {
+    return queuedOn(core) + (idleCores.isIdle(core) ? 0 : 1);
+}
+
+int RRScheduler::selectCore() const {
+    int best = 0;
+    for (int c = 1; c < numCores; ++c) {
+        if (coreLoad(c) < coreLoad(best)) best = c;
+    }
+    return best;
+}
+
+// Work an idle core may take: anything queued behind a busy core, or the backlog of an idle one
+bool RRScheduler::hasStealable(int thief) const {
+    for (int c = 0; c < numCores; ++c) {
+        if (c == thief) continue;
+        int spare = queuedOn(c) - (idleCores.isIdle(c) ? 1 : 0);
+        if (spare > 0) return true;
+    }
+    return false;
+}
+
+bool RRScheduler::pullForIdle(int core) {
+    int busiest = -1;
+    int busiestQueued = 0;
+    for (int c = 0; c < numCores; ++c) {
+        if (c == core) continue;
+        int spare = queuedOn(c) - (idleCores.isIdle(c) ? 1 : 0);
+        if (spare > 0 && queuedOn(c) > busiestQueued) {
+            busiest = c;
+            busiestQueued = queuedOn(c);
+        }
+    }
+    if (busiest == -1) return false;
+    attachToCore(core, detachTail(busiest));
+    return true;
+}
+
+// Periodic balancing: only moves queued processes, and only while the gap exceeds the threshold.
+// A move needs a gap of at least 2 to shrink it, and a pass makes at most one move per queued process.
+// Caller must hold queueMutex
+void RRScheduler::balanceLoad() {
+    if (numCores < 2) return;
+    int queued = 0;
+    for (int c = 0; c < numCores; ++c) queued += queuedOn(c);
+    for (int moves = 0; moves < queued; ++moves) {
+        int busiest = 0, idlest = 0;
+        for (int c = 1; c < numCores; ++c) {
+            if (coreLoad(c) > coreLoad(busiest)) busiest = c;
+            if (coreLoad(c) < coreLoad(idlest)) idlest = c;
+        }
+        int gap = coreLoad(busiest) - coreLoad(idlest);
+        if (gap <= balanceThreshold || gap < 2 || queuedOn(busiest) == 0) break;
+        attachToCore(idlest, detachTail(busiest));
+        wakeCore(idlest);
+    }
+}
+
+// Caller must hold queueMutex
+bool RRScheduler::balanceDue() const {
+    return balanceInterval > 0 && cpuCycles.load() - lastBalanceCycle >= static_cast<uint32_t>(balanceInterval);
+}
+
+// Parks until a core reports that balance-interval ticks have passed
+void RRScheduler::schedulerLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    lastBalanceCycle = cpuCycles.load();
+    while (running) {
+        balancerCv.wait(lock, [this] { return balanceDue() || !running; });
+        if (!running) break;
+        balanceLoad();
+        lastBalanceCycle = cpuCycles.load();
+    }
+}
+
+std::vector<int> RRScheduler::getCoreLoads() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    std::vector<int> loads(numCores);
+    for (int c = 0; c < numCores; ++c) {
+        loads[c] = running ? coreLoad(c) : queuedOn(c);
+    }
+    return loads;
+}
+
+void RRScheduler::setAdaptiveQuantum(int minQ, int maxQ) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    adaptiveQuantum = true;
+    minQuantum = std::max(minQ, 1);
+    maxQuantum = std::max(maxQ, minQuantum);
+}
+
+// Caller must hold queueMutex
+int RRScheduler::sliceFor(Process* proc, int core) {
+    if (!fairMode) {
+        int base = quantumCycles.load();
+        if (!adaptiveQuantum) return base;
+        // Short queue: stretch the quantum to save context switches; long queue: shrink it for latency
+        double quantum = base * 2.0 / (queuedOn(core) + 1);
+        // Faulting processes pay page-in cost at the start of each quantum, so give them longer to amortise it
+        quantum *= 1.0 + std::min(proc->getFaultRate(), 1.0f);
+        // Processes that kept giving the core back early get less, CPU-bound ones get more
+        quantum *= 0.5 + proc->getQuantumUsage();
+        return std::clamp(static_cast<int>(quantum), minQuantum, maxQuantum);
+    }
+    long long total = std::max<long long>(runQueues[core].weight, proc->getWeight());
+    int slice = static_cast<int>(static_cast<long long>(targetLatency) * proc->getWeight() / total);
+    return std::max(slice, minGranularity);
+}
+
+void RRScheduler::chargeVruntime(Process* proc, int ticks) {
+    uint64_t delta = static_cast<uint64_t>(ticks) * VRUNTIME_PER_TICK * NICE_0_WEIGHT / proc->getWeight();
+    proc->setVruntime(proc->getVruntime() + delta);
 }
 
 void RRScheduler::start() {
+    clockStart = std::chrono::steady_clock::now() - INSTRUCTION_TICK * stoppedTick.load();
     running = true;
 
-    availableCores.clear();
-    for (int i = 0; i < numCores; ++i) {
-        availableCores.insert(i);
-    }
-    for (int i = 0; i < numCores; ++i) {
-        cpuThreads.emplace_back(&RRScheduler::cpuWorker, this, i);
+    idleCores.setAll();
+    metrics = SchedulerMetrics();
+    int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+    for (int c = 0; c < numCores; ++c) idleSince[c].store(now);
+
+    // M:N: simulated cores are multiplexed onto at most one host thread per hardware thread
+    int hosts = std::max(1, std::min<int>(std::thread::hardware_concurrency(), numCores));
+    coresPerHost = (numCores + hosts - 1) / hosts;
+    hosts = (numCores + coresPerHost - 1) / coresPerHost;
+    hostCvs.reset(new std::condition_variable[hosts]);
+    numHosts = hosts;
+    for (int h = 0; h < hosts; ++h) {
+        cpuThreads.emplace_back(&RRScheduler::hostWorker, this, h);
     }
+    schedulerThread = std::thread(&RRScheduler::schedulerLoop, this);
 }
 
 void RRScheduler::stop() {
+    if (running) stoppedTick = currentTick();
     running = false;
     processGenActive = false;
-    cv.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (int h = 0; h < numHosts; ++h) hostCvs[h].notify_all();
+        balancerCv.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(genMutex);
+        genCv.notify_all();
+    }
 
     for (auto& t : cpuThreads) {
         if (t.joinable()) t.join();
@@ -63,6 +310,26 @@ void RRScheduler::stop() {
 
     if (schedulerThread.joinable()) schedulerThread.join();
     if (processGeneratorThread.joinable()) processGeneratorThread.join();
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    requeueCores();
+}
+
+// Preempts the processes left on a core by stop(): each goes back on its core's run queue
+// Caller must hold queueMutex
+void RRScheduler::requeueCores() {
+    for (int c = 0; c < numCores; ++c) {
+        CoreState& cs = cores[c];
+        Process* proc = cs.proc;
+        if (!proc) continue;
+        chargeVruntime(proc, cs.quantum);
+        proc->transition(ProcessState::Ready, currentTick());
+        proc->recordPreemption();
+        enqueueOn(c, proc);
+        cs = CoreState();
+        runningSlots[c].store(nullptr, std::memory_order_release);
+        idleCores.release(c);
+    }
 }
 
 bool RRScheduler::isRunning() const {
@@ -70,18 +337,51 @@ bool RRScheduler::isRunning() const {
 }
 
 std::vector<Process*> RRScheduler::getRunningProcesses() {
+    std::vector<Process*> procs;
+    for (int c = 0; c < numCores; ++c) {
+        Process* proc = runningSlots[c].load(std::memory_order_acquire);
+        if (proc) procs.push_back(proc);
+    }
+    return procs;
+}
+
+bool RRScheduler::getFinishedProcesses(const ArchiveQuery& query, std::vector<ProcessSummary>& out) {
     std::lock_guard<std::mutex> lock(queueMutex);
-    return runningProcesses;
+    return finishedProcesses.select(query, out);
 }
 
-std::vector<Process*> RRScheduler::getFinishedProcesses() {
+size_t RRScheduler::getFinishedCount() {
     std::lock_guard<std::mutex> lock(queueMutex);
-    return finishedProcesses;
+    return finishedProcesses.size();
 }
 
-std::vector<Process*> RRScheduler::getReadyProcesses() {
+bool RRScheduler::findFinishedProcess(const std::string& name, ProcessSummary& out) {
+    IndexEntry entry;
+    if (!index.findByName(name, entry) || entry.archived < 0) return false;
     std::lock_guard<std::mutex> lock(queueMutex);
-    return readyProcesses;
+    // It may have been dropped from the archive since the lookup
+    if (!finishedProcesses.contains(static_cast<size_t>(entry.archived))) return false;
+    out = finishedProcesses[static_cast<size_t>(entry.archived)];
+    return true;
+}
+
+Process* RRScheduler::findLiveProcess(const std::string& name) {
+    IndexEntry entry;
+    return index.findByName(name, entry) ? entry.live : nullptr;
+}
+
+bool RRScheduler::findNameByPid(int pid, std::string& name) {
+    ProcessReclaimer::Guard guard;
+    IndexEntry entry;
+    if (!index.findByPid(pid, entry)) return false;
+    if (entry.live) {
+        name = entry.live->getName();
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (entry.archived < 0 || !finishedProcesses.contains(static_cast<size_t>(entry.archived))) return false;
+    name = finishedProcesses[static_cast<size_t>(entry.archived)].name;
+    return true;
 }
 
 uint32_t RRScheduler::getCpuCycles() {
@@ -90,202 +390,347 @@ uint32_t RRScheduler::getCpuCycles() {
 
 float RRScheduler::getCpuUtilization() {
     int totalCores = numCores;
-    int busyCores = 0;
-    {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        if (!running) {
-            busyCores = 0;
-        } else {
-            busyCores = totalCores - static_cast<int>(availableCores.size());
-        }
-    }
+    int busyCores = running ? totalCores - idleCores.count() : 0;
     if (totalCores == 0) return 0.0f;
     float cpuUtilization = (static_cast<float>(busyCores) * 100.0f) / totalCores;
     return cpuUtilization;
 }
 
-void RRScheduler::cpuWorker(int coreId) {
-    static std::set<std::string> allocatedSet;
-    while (running) {
-        Process* proc = nullptr;
-        int assignedCore = -1;
-
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            cv.wait(lock, [this] { return (!readyQueue.empty() && !availableCores.empty()) || !running; });
-            if (!running) break;
+// One host thread steps a contiguous batch of simulated cores. Idle cores pick up work as soon as
+// it is queued; busy cores advance one instruction per INSTRUCTION_TICK,
+// ticks-per-step ticks at a time.
+void RRScheduler::hostWorker(int hostId) {
+    int first = hostId * coresPerHost;
+    int last = std::min(first + coresPerHost, numCores);
+    // Ticks each core advances per wakeup. Batch mode retires ALU ops between ticks, so it steps singly.
+    const int step = execution_mode == "batch" ? 1 : std::max(1, ticks_per_step);
+    auto nextTick = std::chrono::steady_clock::now() + INSTRUCTION_TICK * step;
+    BatchInterpreter batch; // this host's ALU ops for the current tick (execution-mode "batch")
+    std::unique_lock<std::mutex> lock(queueMutex);
 
-            if (!readyQueue.empty() && !availableCores.empty()) {
-                proc = readyQueue.front();
-                readyQueue.pop();
-                assignedCore = *availableCores.begin();
+    while (running) {
+        advanceTimers();
+        bool busy = false;
+        for (int c = first; c < last; ++c) {
+            if (!cores[c].proc) dispatchCore(c);
+            if (cores[c].proc) busy = true;
+        }
 
-                if (std::find(runningProcesses.begin(), runningProcesses.end(), proc) == runningProcesses.end()) {
-                    runningProcesses.push_back(proc);
+        if (!busy) {
+            // Whole batch idle: park the host thread until work is targeted at one of its cores.
+            // Host 0 also keeps the timer wheel turning, so it only parks until the next tick while anyone sleeps.
+            auto hasWork = [this, first, last] {
+                if (!running) return true;
+                for (int c = first; c < last; ++c) {
+                    if (queuedOn(c) > 0 || hasStealable(c)) return true;
                 }
-                availableCores.erase(availableCores.begin());
+                return false;
+            };
+            if (hostId == 0 && !timers.empty()) {
+                hostCvs[hostId].wait_until(lock, clockStart + INSTRUCTION_TICK * (timers.getCurrentTick() + 1), hasWork);
+            } else {
+                hostCvs[hostId].wait(lock, [this, hostId, &hasWork] { return hasWork() || (hostId == 0 && !timers.empty()); });
             }
+            nextTick = std::chrono::steady_clock::now() + INSTRUCTION_TICK * step;
+            continue;
         }
 
-        if (proc && assignedCore != -1 && proc->getStatus() == "Ready") {
-            proc->setCpuId(assignedCore);
-            int quantum = 0;
-            uint32_t targetCycle = cpuCycles.load() + delay_per_exec;
+        if (std::chrono::steady_clock::now() < nextTick) {
+            hostCvs[hostId].wait_until(lock, nextTick);
+            continue;
+        }
+        nextTick += INSTRUCTION_TICK * step;
 
-            int totalInstr = proc->getTotalLines();
-            int cur_instr = proc->getCurrentLine();
-            int numPages = ceil(proc->getMemSize() / mem_per_frame);
+        lock.unlock();
+        for (int c = first; c < last; ++c) {
+            if (cores[c].proc) stepCore(c, batch, step);
+        }
+        if (!batch.empty()) batch.run();
+        lock.lock();
 
-            /* for (int i = 0; i < numPages; ++i) {
-                std::cout << "Process: " << proc->getName() << ", Page: " << i << std::endl;
-            } */
+        for (int c = first; c < last; ++c) {
+            if (cores[c].proc && (cores[c].quantumDone || cores[c].proc->isFinished())) endQuantum(c);
+        }
+        if (balanceDue()) balancerCv.notify_one();
+    }
+}
 
-            while (quantum < quantumCycles && proc->getCurrentLine() < proc->getTotalLines()) {
-                std::string victimProc = "";
-                int address = proc->getCurrentLine();
-                proc->setStatus("Running");
-                int pageNumber = (address / mem_per_frame) - 1;
-                if (pageNumber < 0) pageNumber = 0;
+// Caller must hold queueMutex
+bool RRScheduler::dispatchCore(int core) {
+    if (queuedOn(core) == 0 && !pullForIdle(core)) return false;
+    Process* proc = dequeueFrom(core);
+    uint64_t tick = currentTick();
+    if (!proc->transition(ProcessState::Ready, ProcessState::Running, tick)) return false;
+    proc->recordDispatch(tick);
+
+    CoreState& cs = cores[core];
+    cs = CoreState();
+    cs.proc = proc;
+    cs.slice = sliceFor(proc, core);
+    idleCores.claim(core);
+    runningSlots[core].store(proc, std::memory_order_release);
+    idleTicks += ticksSince(idleSince[core].exchange(0));
+
+    // Soft affinity miss: the first ticks of the slice go to refilling cache, TLB and working set
+    if (proc->getCpuId() != -1 && proc->getCpuId() != core) {
+        proc->addMigration();
+        migrations++;
+        cs.stallTicks = std::min(migrationCost, cs.slice - 1);
+    }
+    proc->setCpuId(core);
+    proc->startTask(memoryManager, page_fault_ticks);
+    cs.faultsAtDispatch = proc->getPageFaults();
 
-                memoryManager->accessPage(proc->getName(), pageNumber);
+    // Pass any leftover backlog on to another parked core
+    if (hasStealable(core)) wakeCore(idleCores.findIdle(core));
+    return true;
+}
 
-                if (delay_per_exec > 0) {
-                    while (cpuCycles.load() < targetCycle) {
-                        cpuCycles++;
-                    }
-                }
+// Advances one busy core by up to `ticks` ticks, stopping once its quantum is over.
+// Only the owning host thread touches cores[core].
+void RRScheduler::stepCore(int core, BatchInterpreter& batch, int ticks) {
+    CoreState& cs = cores[core];
+    Process* proc = cs.proc;
+    int used = 0;
+
+    while (used < ticks && !cs.quantumDone) {
+        int left = ticks - used;
+        if (cs.delayTicks > 0) {
+            int n = std::min(cs.delayTicks, left);
+            cs.delayTicks -= n;
+            used += n;
+            continue;
+        }
+        if (cs.stallTicks > 0 || cs.waitTicks > 0) {
+            // Migration warm-up or an outstanding page-in: the core is held but nothing executes
+            int& pending = cs.stallTicks > 0 ? cs.stallTicks : cs.waitTicks;
+            int n = std::min(pending, left);
+            pending -= n;
+            used += n;
+            cs.quantum += n;
+            continue;
+        }
 
-                //proc->executeCurrentCommand(assignedCore, proc->getName(), "");
-                proc->executeCurrentCommand2();
-                //(to catch 100% or 0% cpu utilization)
-                std::this_thread::sleep_for(std::chrono::milliseconds(1000)); 
-                proc->moveCurrentLine();
-                cpuCycles++;
-                activeTicks++;
-                quantum++;
-            }
+        // The page-in is over
+        if (proc->getState() == ProcessState::Blocked) proc->transition(ProcessState::Running, currentTick());
+        SliceResult slice = proc->executeSlice(std::max(1, cs.slice - cs.quantum), left);
+        used += slice.ticks;
+        cs.quantum += slice.steps;
+        cs.delayTicks = slice.delayLeft;
+        switch (slice.stop) {
+        case SuspendReason::Tick:
+        case SuspendReason::Finished:
+            break;
+        case SuspendReason::Alu:
+            // Executed by the host after every core has stepped; the finished check waits for it
+            batch.add(proc);
+            break;
+        case SuspendReason::PageIn:
+            cs.waitTicks = slice.waitTicks;
+            proc->transition(ProcessState::Blocked, currentTick());
+            break;
+        case SuspendReason::Sleep:
+            // Give the core back now rather than holding it for the whole sleep
+            cs.sleepTicks = slice.waitTicks;
+            cs.quantumDone = true;
+            break;
+        }
 
-            bool finished = proc->getCurrentLine() >= proc->getTotalLines();
-
-            {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                if (finished) {
-                    proc->setEndTime(getCurrentTimestamp());
-                    proc->setStatus("Finished");
-                    finishedProcesses.push_back(proc);
-                    memoryManager->freeProcessMemory(proc->getName());
-                    allocatedSet.erase(proc->getName());
-                } else {
-                    proc->setStatus("Ready");
-                    readyQueue.push(proc);
-                }
+        if (cs.quantum >= cs.slice || proc->isFinished()) cs.quantumDone = true;
+        if (slice.stop == SuspendReason::Alu) break;
+    }
+    cpuCycles += used;
+    activeTicks += used;
+}
 
-                runningProcesses.erase(std::remove(runningProcesses.begin(), runningProcesses.end(), proc), runningProcesses.end());
-                availableCores.insert(assignedCore);
-                cv.notify_all();
-            }
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            cpuCycles++;
-            idleTicks++;
-        }
+// Caller must hold queueMutex
+void RRScheduler::endQuantum(int core) {
+    CoreState& cs = cores[core];
+    Process* proc = cs.proc;
+    chargeVruntime(proc, cs.quantum);
+    proc->recordQuantum(cs.slice, cs.quantum, proc->getPageFaults() - cs.faultsAtDispatch);
+
+    if (proc->isFinished()) {
+        proc->setEndTime(Timestamp::now(currentTick()));
+        proc->transition(ProcessState::Finished, currentTick());
+        proc->recordCompletion(proc->getStateEnteredAt(ProcessState::Finished));
+        metrics.record(*proc);
+        ProcessSummary dropped;
+        if (finishedProcesses.append(ProcessSummary::of(*proc), dropped)) index.remove(dropped.name, dropped.pid);
+        index.archive(proc, finishedProcesses.size() - 1);
+        logSink.closeProcess(static_cast<std::uint32_t>(proc->getPid()));
+        runQueues[core].weight -= proc->getWeight();
+        memoryManager->freeProcessMemory(proc->getName());
+    } else if (cs.sleepTicks > 0) {
+        // Off the run queue until the timer fires; the weight leaves the core with it
+        proc->transition(ProcessState::Sleeping, currentTick());
+        runQueues[core].weight -= proc->getWeight();
+        proc->setWakeTick(currentTick() + cs.sleepTicks);
+        timers.schedule(proc, proc->getWakeTick());
+        hostCvs[0].notify_one();
+    } else {
+        proc->transition(ProcessState::Ready, currentTick());
+        proc->recordPreemption();
+        enqueueOn(core, proc);
     }
+
+    cs.proc = nullptr;
+    runningSlots[core].store(nullptr, std::memory_order_release);
+    idleSince[core].store(std::chrono::steady_clock::now().time_since_epoch().count());
+    idleCores.release(core);
+    // Unreachable now except through guards the console already holds
+    if (proc->getState() == ProcessState::Finished) processReclaimer.retire(proc);
+    if (hasStealable(core)) wakeCore(idleCores.findIdle(core));
+}
+
+uint64_t RRScheduler::currentTick() const {
+    if (!running) return stoppedTick.load();
+    return static_cast<uint64_t>((std::chrono::steady_clock::now() - clockStart) / INSTRUCTION_TICK);
+}
+
+// Requeues every sleeper whose timer has expired, preferring the core it last ran on
+// Caller must hold queueMutex
+void RRScheduler::advanceTimers() {
+    if (timers.empty()) return;
+    std::vector<Process*> expired;
+    timers.advance(currentTick(), expired);
+    for (Process* proc : expired) {
+        proc->transition(ProcessState::Ready, currentTick());
+        int core = proc->getCpuId() >= 0 ? proc->getCpuId() : selectCore();
+        attachToCore(core, proc);
+        wakeCore(idleCores.isIdle(core) ? core : idleCores.findIdle());
+    }
+}
+
+SchedulerMetrics RRScheduler::getMetrics() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return metrics;
+}
+
+std::vector<std::pair<Process*, int>> RRScheduler::getSleepingProcesses() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    std::vector<std::pair<Process*, int>> sleeping;
+    uint64_t now = currentTick();
+    for (const auto& [proc, expiry] : timers.entries()) {
+        sleeping.emplace_back(proc, expiry > now ? static_cast<int>(expiry - now) : 0);
+    }
+    return sleeping;
+}
+
+// Caller must hold queueMutex
+void RRScheduler::wakeCore(int core) {
+    if (core >= 0) hostCvs[hostOf(core)].notify_one();
 }
 
 void RRScheduler::startProcessGenerator(int batchFreq) {
     batchProcessFreq = batchFreq;
     processGenActive = true;
+    generationPool.start(generator_threads);
     processGeneratorThread = std::thread(&RRScheduler::processGeneratorFunc, this);
 }
 
 void RRScheduler::stopProcessGenerator() {
     processGenActive = false;
+    {
+        std::lock_guard<std::mutex> lock(genMutex);
+        genCv.notify_all();
+    }
     if (processGeneratorThread.joinable()) processGeneratorThread.join();
-}
-
-std::string RRScheduler::getCurrentTimestamp() {
-    std::time_t now = std::time(nullptr);
-    std::tm localTime;
-#ifdef _WIN32
-    localtime_s(&localTime, &now);
-#else
-    localtime_r(&now, &localTime);
-#endif
-    std::ostringstream oss;
-    oss << std::put_time(&localTime, "%m/%d/%Y, %I:%M:%S %p");
-    return oss.str();
+    generationPool.stop();
 }
 
 void RRScheduler::processGeneratorFunc() {
-    uint32_t lastCycle = -1;
     while (processGenActive && running) {
-        uint32_t cycle = getCpuCycles();
-        if (batchProcessFreq > 0 && cycle % batchProcessFreq == 0 && lastCycle != cycle) {
-            // Only allow mem_for_proc to be a power of 2 between min and max (inclusive)
-            int min_exp = static_cast<int>(std::log2(min_mem_per_proc));
-            int max_exp = static_cast<int>(std::log2(max_mem_per_proc));
-            int chosen_exp = min_exp + (std::rand() % (max_exp - min_exp + 1));
-            int mem_for_proc = 1 << chosen_exp;
-
-            int numPages = ceil(mem_for_proc / mem_per_frame);
-            int totalFrames = max_overall_mem / mem_per_frame;
-            int usedFrames = 0;
-            {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                for (const auto& pt : memoryManager->getPageTables()) {
-                    for (const auto& entry : pt.second) {
-                        if (entry.valid) ++usedFrames;
-                    }
+        {
+            // Sleep until the next batch is due instead of polling every tick
+            std::unique_lock<std::mutex> lock(genMutex);
+            auto stopping = [this] { return !processGenActive || !running; };
+            if (batchProcessFreq > 0) {
+                genCv.wait_for(lock, TICK_DURATION * batchProcessFreq, stopping);
+            } else {
+                genCv.wait(lock, stopping);
+            }
+        }
+        if (!processGenActive || !running) break;
+
+        // Admission is decided serially in pid order; each pid's numbers come from its own
+        // (seed, pid) stream, so the same config seed spawns the same processes
+        int min_exp = static_cast<int>(std::log2(min_mem_per_proc));
+        int max_exp = static_cast<int>(std::log2(max_mem_per_proc));
+        int totalFrames = max_overall_mem / mem_per_frame;
+        int usedFrames = 0;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            for (const auto& pt : memoryManager->getPageTables()) {
+                for (const auto& entry : pt.second) {
+                    if (entry.valid) ++usedFrames;
                 }
             }
+        }
 
-            int totalInstructions = min_ins + (std::rand() % (max_ins - min_ins + 1));
-            std::string processName = "auto_proc_" + std::to_string(curr_id);
-            std::string timestamp = getCurrentTimestamp();
-            Process* newProcess = new Process(curr_id, processName, 0, totalInstructions, timestamp, "Ready", mem_for_proc);
-
-            if (usedFrames + numPages <= totalFrames) {
-                curr_id++;
-                newProcess->createPrintCommands(totalInstructions);
-
-                /* 
-                Calculate totalInstrBytes after instructions are generated
-                int totalInstrBytes = 0;
-                for (const std::string& cmd : newProcess->getAllInstructions()) {
-                    totalInstrBytes += getInstructionSize(cmd);
-                }
+        struct Spawn {
+            Process* process;
+            int totalInstructions;
+            std::uint64_t programSeed;
+        };
+        std::vector<Spawn> batch;
+        Timestamp timestamp = Timestamp::now(currentTick());
+        for (int i = 0; i < std::max(1, batch_process_size); ++i) {
+            SplitMix64 stream(SplitMix64::streamSeed(random_seed, static_cast<std::uint64_t>(curr_id)));
+            // Only allow mem_for_proc to be a power of 2 between min and max (inclusive)
+            int mem_for_proc = 1 << stream.range(min_exp, max_exp);
+            int numPages = static_cast<int>(ceil(mem_for_proc / mem_per_frame));
+            if (usedFrames + numPages > totalFrames) break;
+            usedFrames += numPages;
 
-                std::cout << "[DEBUG] " << processName
-                          << " | mem_for_proc=" << mem_for_proc
-                          << " | totalInstructions=" << totalInstructions
-                          << " | totalInstrBytes=" << totalInstrBytes << std::endl;
-                */
+            int totalInstructions = stream.range(min_ins, max_ins);
+            std::string processName = "auto_proc_" + std::to_string(curr_id);
+            Process* newProcess = new Process(curr_id, processName, 0, totalInstructions, timestamp, mem_for_proc);
+            newProcess->setWeight(default_weight);
+            batch.push_back({ newProcess, totalInstructions, stream.next() });
+            curr_id++;
+        }
 
-                addProcess(newProcess);
-                lastCycle = cycle;
+        // Programs are independent, so they are built across the pool
+        generationPool.parallelFor(static_cast<int>(batch.size()), [&batch](int i) {
+            const Spawn& spawn = batch[i];
+            if (program_generation == "lazy") {
+                spawn.process->createLazyProgram(spawn.totalInstructions, spawn.programSeed);
+            } else {
+                spawn.process->createPrintCommands(spawn.totalInstructions, spawn.programSeed);
             }
+        });
+
+        for (const Spawn& spawn : batch) {
+            addProcess(spawn.process);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        cpuCycles++;
-        idleTicks++;
     }
 }
 
 
 int RRScheduler::getBusyCores() {
-    std::lock_guard<std::mutex> lock(queueMutex);
     if (!running) return 0;
-    return numCores - static_cast<int>(availableCores.size());
+    return numCores - idleCores.count();
 }
 
 int RRScheduler::getAvailableCores() {
-    std::lock_guard<std::mutex> lock(queueMutex);
     if (!running) return numCores;
-    return static_cast<int>(availableCores.size());
+    return idleCores.count();
+}
+
+// Finished idle periods plus the time cores have been parked so far
+int RRScheduler::getIdleTicks() const {
+    int total = idleTicks.load();
+    for (int c = 0; c < numCores; ++c) {
+        total += ticksSince(idleSince[c].load());
+    }
+    return total;
 }
 
 void RRScheduler::printVMStat(){
-    memoryManager->printVMStat(cpuCycles.load(), idleTicks.load(), activeTicks.load());
+    int idle = getIdleTicks();
+    int active = activeTicks.load();
+    memoryManager->printVMStat(idle + active, idle, active);
 }
 
 void RRScheduler::printProcessSMI(){
@@ -304,7 +749,8 @@ void RRScheduler::printProcessSMI(){
     oss << "\n===========================================\n";
     oss << "Running processes and memory usage:\n";
     oss << "-------------------------------------------\n";
-    for(auto& proc : runningProcesses) {
+    ProcessReclaimer::Guard guard;
+    for(auto* proc : getRunningProcesses()) {
         std::string startAddr = "0x0040";
         int memUsage = memoryManager->getProcessMemoryUsage(proc->getName());
         oss << proc->getName() << " (" << memUsage << "KiB) \n";
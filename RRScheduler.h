@@ -5,7 +5,18 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <set>
+#include <map>
+#include <deque>
+#include "CoreMask.h"
+#include "TimerWheel.h"
+#include "WorkerPool.h"
+#include "BatchInterpreter.h"
+#include "LatencyHistogram.h"
+#include "ProcessArchive.h"
+#include "ProcessReclaimer.h"
+#include "ProcessIndex.h"
 #include "Process.h"
 #include "MemoryManager.h"
 
@@ -19,8 +30,15 @@ public:
     void stop();
     bool isRunning() const;
     std::vector<Process*> getRunningProcesses();
-    std::vector<Process*> getFinishedProcesses();
-    std::vector<Process*> getReadyProcesses();
+    // One page of the finished processes' summaries, in completion order (see ArchiveQuery);
+    // returns whether older matches remain
+    bool getFinishedProcesses(const ArchiveQuery& query, std::vector<ProcessSummary>& out);
+    size_t getFinishedCount();
+    bool findFinishedProcess(const std::string& name, ProcessSummary& out);
+    // Admitted, unfinished process with this name; the caller must hold a ProcessReclaimer::Guard
+    Process* findLiveProcess(const std::string& name);
+    // Name of the live or archived process with this pid
+    bool findNameByPid(int pid, std::string& name);
     void startProcessGenerator(int batchFreq);
     void stopProcessGenerator();
     uint32_t getCpuCycles();
@@ -29,34 +47,121 @@ public:
     int getBusyCores();
     int getAvailableCores();
     int getActiveTicks() const { return activeTicks.load(); }
-    int getIdleTicks() const { return idleTicks.load(); }
+    int getIdleTicks() const;
     void printVMStat();
     void printProcessSMI();
 
+    // CFS mode: ready set ordered by vruntime, slice = targetLatency * weight / runnable weight
+    void setFairScheduling(int targetLatency, int minGranularity);
+    bool isFairScheduling() const { return fairMode; }
+
+    // Adaptive quantum: per-dispatch quantum from queue length, fault rate and recent usage
+    void setAdaptiveQuantum(int minQuantum, int maxQuantum);
+    void setQuantumCycles(int cycles) { quantumCycles = cycles > 0 ? cycles : 1; }
+    int getQuantumCycles() const { return quantumCycles.load(); }
+
+    // Soft affinity / load balancing stats
+    std::vector<int> getCoreLoads();
+    int getMigrations() const { return migrations.load(); }
+
+    // Processes blocked in SLEEP, with the ticks left before they are requeued
+    std::vector<std::pair<Process*, int>> getSleepingProcesses();
+    // Latency distributions of the processes finished since start()
+    SchedulerMetrics getMetrics();
+    // Ticks the scheduler has run for, paused between stop() and start(): INSTRUCTION_TICK each
+    uint64_t currentTick() const;
+
 private:
     MemoryManager* memoryManager;
-    void cpuWorker(int coreId);
+    void hostWorker(int hostId);
+    bool dispatchCore(int core);
+    void stepCore(int core, BatchInterpreter& batch, int ticks);
+    void endQuantum(int core);
+    void requeueCores();
+    int hostOf(int core) const { return core / coresPerHost; }
     void processGeneratorFunc();
-    std::string getCurrentTimestamp();
+    void wakeCore(int core);
+    void enqueueOn(int core, Process* proc);
+    Process* dequeueFrom(int core);
+    Process* detachTail(int core);
+    void attachToCore(int core, Process* proc);
+    int queuedOn(int core) const;
+    int coreLoad(int core) const;
+    int selectCore() const;
+    bool hasStealable(int thief) const;
+    bool pullForIdle(int core);
+    void balanceLoad();
+    bool balanceDue() const;
+    int sliceFor(Process* proc, int core);
+    void chargeVruntime(Process* proc, int ticks);
+    void advanceTimers();
 
     int numCores;
-    int quantumCycles;
-    std::vector<std::thread> cpuThreads;
-    std::queue<Process*> readyQueue;
-    std::vector<Process*> runningProcesses;
-    std::vector<Process*> finishedProcesses;
-    std::vector<Process*> readyProcesses;
+    std::atomic<int> quantumCycles;
+    bool adaptiveQuantum = false;
+    int minQuantum = 1;
+    int maxQuantum = 1;
+    std::vector<std::thread> cpuThreads; // host worker pool
+    CoreMask idleCores; // bit set = core idle
+    std::unique_ptr<std::atomic<Process*>[]> runningSlots; // process on each core, nullptr when idle
+    ProcessArchive finishedProcesses; // guarded by queueMutex
+    ProcessIndex index; // every admitted process by name and pid, live or archived
     std::mutex queueMutex;
     std::mutex memMutex;
-    std::condition_variable cv;
+    std::unique_ptr<std::atomic<int64_t>[]> idleSince; // steady_clock ticks when the core went idle, 0 while busy
+
+    // Simulated core state machine, stepped by the host thread that owns the core
+    struct CoreState {
+        Process* proc = nullptr;
+        int slice = 0;        // quantum granted at dispatch
+        int quantum = 0;      // ticks of the slice used so far
+        int faultsAtDispatch = 0;
+        int stallTicks = 0;   // migration warm-up left
+        int waitTicks = 0;    // page-in the process is blocked on
+        int sleepTicks = 0;   // SLEEP: leave the core and wait on the timer wheel
+        int delayTicks = 0;   // delay-per-exec busy-wait left
+        bool quantumDone = false;
+    };
+    std::vector<CoreState> cores;
+    int coresPerHost = 1;
+    int numHosts = 0;
+    std::unique_ptr<std::condition_variable[]> hostCvs; // idle host threads park here (with queueMutex)
+    std::mutex genMutex;
+    std::condition_variable genCv;
     std::atomic<uint32_t> cpuCycles{0};
     std::atomic<bool> running;
-    std::set<int> availableCores;
     std::atomic<bool> processGenActive{false};
     std::thread processGeneratorThread;
     int batchProcessFreq = 0;
+    WorkerPool generationPool; // builds each batch's programs in parallel
     bool tickRunning = false;
     std::thread schedulerThread;
     std::atomic<int> activeTicks{0};
     std::atomic<int> idleTicks{0};
+
+    // Per-core run queue; a preempted process goes back to the core it ran on
+    struct RunQueue {
+        std::deque<Process*> fifo;                  // RR order
+        std::multimap<uint64_t, Process*> tree;     // CFS order (by vruntime)
+        long long weight = 0;                       // total weight of processes attached to this core
+    };
+    std::vector<RunQueue> runQueues; // guarded by queueMutex
+    int migrationCost = 0;
+    int balanceInterval = 0;
+    int balanceThreshold = 1;
+    std::atomic<int> migrations{0};
+    std::condition_variable balancerCv;
+    uint32_t lastBalanceCycle = 0;
+
+    // Sleeping processes, keyed on currentTick(); kept across stop/start (guarded by queueMutex)
+    TimerWheel timers;
+    SchedulerMetrics metrics; // guarded by queueMutex
+    std::chrono::steady_clock::time_point clockStart; // when tick 0 would have been, had the scheduler never stopped
+    std::atomic<uint64_t> stoppedTick{0}; // currentTick() at the last stop(): held while stopped, resumed by start()
+
+    // CFS state (guarded by queueMutex)
+    bool fairMode = false;
+    int targetLatency = 0;
+    int minGranularity = 1;
+    uint64_t minVruntime = 0;
 };
@@ -0,0 +1,83 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(uint64_t startTick) : currentTick(startTick) {}
+
+void TimerWheel::schedule(Process* proc, uint64_t expiryTick) {
+    // A timer always fires on a future tick, never the one being processed
+    if (expiryTick <= currentTick) expiryTick = currentTick + 1;
+    place({proc, expiryTick});
+    count++;
+}
+
+void TimerWheel::place(const Entry& entry) {
+    uint64_t delta = entry.expiry > currentTick ? entry.expiry - currentTick : 0;
+    for (int level = 0; level < LEVELS; ++level) {
+        if (delta < (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+            int slot = static_cast<int>((entry.expiry >> (SLOT_BITS * level)) & (SLOTS - 1));
+            slots[level][slot].push_back(entry);
+            return;
+        }
+    }
+    overflow.push_back(entry);
+}
+
+// Re-files the slot of `level` that currentTick has just reached into the levels below
+void TimerWheel::cascade(int level) {
+    int slot = static_cast<int>((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    std::vector<Entry> moving;
+    moving.swap(slots[level][slot]);
+    for (const Entry& entry : moving) {
+        place(entry);
+    }
+}
+
+void TimerWheel::advance(uint64_t now, std::vector<Process*>& expired) {
+    if (count == 0) {
+        if (now > currentTick) currentTick = now;
+        return;
+    }
+    while (currentTick < now) {
+        currentTick++;
+
+        // Cascade from the highest level whose lower digits just rolled over
+        int top = 0;
+        while (top < LEVELS - 1 && (currentTick & ((uint64_t(1) << (SLOT_BITS * (top + 1))) - 1)) == 0) {
+            top++;
+        }
+        if (top == LEVELS - 1 && (currentTick & ((uint64_t(1) << (SLOT_BITS * LEVELS)) - 1)) == 0) {
+            std::vector<Entry> far;
+            far.swap(overflow);
+            for (const Entry& entry : far) place(entry);
+        }
+        for (int level = top; level >= 1; --level) {
+            cascade(level);
+        }
+
+        std::vector<Entry>& due = slots[0][currentTick & (SLOTS - 1)];
+        for (const Entry& entry : due) {
+            expired.push_back(entry.proc);
+        }
+        count -= due.size();
+        due.clear();
+
+        if (count == 0) {
+            currentTick = now;
+            break;
+        }
+    }
+}
+
+std::vector<std::pair<Process*, uint64_t>> TimerWheel::entries() const {
+    std::vector<std::pair<Process*, uint64_t>> result;
+    for (int level = 0; level < LEVELS; ++level) {
+        for (int slot = 0; slot < SLOTS; ++slot) {
+            for (const Entry& entry : slots[level][slot]) {
+                result.emplace_back(entry.proc, entry.expiry);
+            }
+        }
+    }
+    for (const Entry& entry : overflow) {
+        result.emplace_back(entry.proc, entry.expiry);
+    }
+    return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Process;
+
+// Hierarchical timing wheel keyed on the scheduler tick clock. Four levels of 64 slots cover
+// 64^4 ticks; anything further out waits in an overflow list. Scheduling is O(1), and each
+// advanced tick touches one level-0 slot plus an occasional cascade from the level above.
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t startTick = 0);
+
+    void schedule(Process* proc, uint64_t expiryTick);
+    // Moves the wheel to `now` and appends every process whose timer has expired to `expired`
+    void advance(uint64_t now, std::vector<Process*>& expired);
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    uint64_t getCurrentTick() const { return currentTick; }
+    // Every pending timer as (process, expiry tick), for monitoring
+    std::vector<std::pair<Process*, uint64_t>> entries() const;
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    struct Entry {
+        Process* proc;
+        uint64_t expiry;
+    };
+
+    void place(const Entry& entry);
+    void cascade(int level);
+
+    std::vector<Entry> slots[LEVELS][SLOTS];
+    std::vector<Entry> overflow;
+    uint64_t currentTick;
+    size_t count = 0;
+};
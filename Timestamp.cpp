@@ -0,0 +1,55 @@
+#include "Timestamp.h"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+using namespace std::chrono;
+
+std::int64_t steadyNanos() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+Timestamp Timestamp::now(std::uint64_t tick) {
+    return Timestamp{tick, steadyNanos()};
+}
+
+// Wall-clock seconds of a steady_clock reading, through one (steady, system) pair taken on first use
+static std::time_t wallSeconds(std::int64_t ns) {
+    static const std::int64_t steadyAnchor = steadyNanos();
+    static const std::int64_t systemAnchor = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    std::int64_t wall = systemAnchor + (ns - steadyAnchor);
+    std::int64_t seconds = wall / 1000000000;
+    if (wall % 1000000000 < 0) --seconds;
+    return static_cast<std::time_t>(seconds);
+}
+
+void appendTime(std::string& out, std::int64_t ns, TimeFormat format) {
+    struct Cached {
+        std::time_t second = -1;
+        std::string text;
+    };
+    thread_local Cached cache[2];
+
+    std::time_t seconds = wallSeconds(ns);
+    Cached& cached = cache[format == TimeFormat::Log];
+    if (cached.second != seconds) {
+        std::tm localTime;
+#ifdef _WIN32
+        localtime_s(&localTime, &seconds);
+#else
+        localtime_r(&seconds, &localTime);
+#endif
+        std::ostringstream timeStream;
+        timeStream << std::put_time(&localTime, format == TimeFormat::Log ? "(%m/%d/%Y %I:%M:%S%p)" : "%m/%d/%Y, %I:%M:%S %p");
+        cached.second = seconds;
+        cached.text = timeStream.str();
+    }
+    out += cached.text;
+}
+
+std::string formatTime(std::int64_t ns, TimeFormat format) {
+    std::string out;
+    appendTime(out, ns, format);
+    return out;
+}
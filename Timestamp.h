@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// When an event happened: the scheduler tick and steady_clock nanoseconds. Cheap to take and to
+// compare; turned into local time only when shown (see formatTime).
+struct Timestamp {
+    std::uint64_t tick = 0; // scheduler tick, 0 when taken before the scheduler started
+    std::int64_t ns = 0;    // steady_clock since its epoch, 0 = never
+
+    static Timestamp now(std::uint64_t tick = 0);
+    bool valid() const { return ns != 0; }
+    bool operator<(const Timestamp& other) const { return ns < other.ns; }
+};
+
+enum class TimeFormat {
+    Display, // "10/19/2026, 03:04:05 PM", screen -ls and screen -r
+    Log,     // "(10/19/2026 03:04:05PM)", execution and PRINT logs
+};
+
+std::int64_t steadyNanos();
+
+// Appends the local wall time of a steady_clock reading. The formatted second is cached per
+// thread and format, so runs of events within one second cost a copy each.
+void appendTime(std::string& out, std::int64_t ns, TimeFormat format);
+std::string formatTime(std::int64_t ns, TimeFormat format);
+inline std::string formatTime(const Timestamp& time, TimeFormat format) {
+    return time.valid() ? formatTime(time.ns, format) : std::string();
+}
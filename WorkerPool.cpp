@@ -0,0 +1,69 @@
+#include "WorkerPool.h"
+
+void WorkerPool::start(int threads) {
+    stop();
+    stopping = false;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(&WorkerPool::workerFunc, this);
+    }
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workCv.notify_all();
+    for (auto& t : workers) {
+        if (t.joinable()) t.join();
+    }
+    workers.clear();
+}
+
+// Takes indices of the current job until none are left (called with mutex unlocked)
+void WorkerPool::runJobs() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (job && nextIndex < jobCount) {
+        int index = nextIndex++;
+        const std::function<void(int)>* current = job;
+        lock.unlock();
+        (*current)(index);
+        lock.lock();
+        if (--pending == 0) doneCv.notify_all();
+    }
+}
+
+void WorkerPool::workerFunc() {
+    std::uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workCv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runJobs();
+    }
+}
+
+void WorkerPool::parallelFor(int count, const std::function<void(int)>& fn) {
+    if (count <= 0) return;
+    if (workers.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        nextIndex = 0;
+        pending = count;
+        generation++;
+    }
+    workCv.notify_all();
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this] { return pending == 0; });
+    job = nullptr;
+}
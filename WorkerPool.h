@@ -0,0 +1,34 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of helper threads for data-parallel jobs. parallelFor blocks until every index has
+// run, and the calling thread takes indices too, so a pool of 1 thread runs everything inline.
+class WorkerPool {
+public:
+    ~WorkerPool() { stop(); }
+
+    // Total threads including the caller; values below 1 are treated as 1
+    void start(int threads);
+    void stop();
+    void parallelFor(int count, const std::function<void(int)>& job);
+
+private:
+    void workerFunc();
+    void runJobs();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workCv;
+    std::condition_variable doneCv;
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    int nextIndex = 0; // next index to hand out (guarded by mutex)
+    int pending = 0;   // indices handed out or waiting, not finished yet
+    std::uint64_t generation = 0;
+    bool stopping = false;
+};
@@ -1 +1 @@
-g++ emulator.cpp FCFSScheduler.cpp MemoryManager.cpp PagingAllocator.cpp PrintCommand.cpp Process.cpp RRScheduler.cpp -o emulator
+g++ -std=c++20 emulator.cpp FCFSScheduler.cpp MemoryManager.cpp Process.cpp Program.cpp ProgramGenerator.cpp RRScheduler.cpp TimerWheel.cpp WorkerPool.cpp BatchInterpreter.cpp LatencyHistogram.cpp ProcessArchive.cpp ProcessReclaimer.cpp ProcessIndex.cpp LogSink.cpp Timestamp.cpp -o emulator
\ No newline at end of file
@@ -9,8 +9,9 @@
 #include <vector>
 #include <fstream>
 #include <mutex>
+#include <limits>
+#include <initializer_list>
 #include "Process.h"
-#include "PrintCommand.h"
 #include "FCFSScheduler.h"
 #include "RRScheduler.h"
 #include "MemoryManager.h"
@@ -18,6 +19,7 @@
 #include <condition_variable>
 #include <atomic>
 #include <algorithm>
+#include <cctype>
 #include <random> // Include for random number generation
 
 std::string trim(const std::string& str) {
@@ -130,24 +132,43 @@ int randInt(int min, int max) {
     return min + (std::rand() % (max - min + 1));
 }
 
-int num_cpu;
-std::string scheduler;
-int quantum_cycles;
-int batch_process_freq;
-int min_ins;
-int max_ins;
-int delay_per_exec;
+int num_cpu = 1;
+std::string scheduler = "rr";
+int quantum_cycles = 10;
+int batch_process_freq = 1;
+int min_ins = 1000;
+int max_ins = 1000;
+int delay_per_exec = 0;
 FCFSScheduler* fcfsScheduler = nullptr;
 RRScheduler* rrScheduler = nullptr;
 int curr_id = 0;
-int max_overall_mem;
-int mem_per_frame;
-int min_mem_per_proc;
-int max_mem_per_proc;
+int max_overall_mem = 256;
+int mem_per_frame = 256;
+int min_mem_per_proc = 256;
+int max_mem_per_proc = 256;
+int target_latency = 0;
+int min_granularity = 1;
+int default_weight = 1024;
+int migration_cost = 0;
+int balance_interval = 10;
+int balance_threshold = 1;
+std::string quantum_mode = "fixed";
+int min_quantum = 1;
+int max_quantum = 0;
+int page_fault_ticks = 0;
+std::string program_generation = "eager";
+std::string program_optimization = "none"; // "none" or "peephole"
+std::string execution_mode = "scalar"; // "scalar" or "batch" (ALU ops of a host's cores run together)
+int ticks_per_step = 1; // ticks a host thread advances its cores by per wakeup
+std::uint64_t random_seed = 0; // workload seed; every process derives its own stream from (seed, pid)
+bool random_seed_set = false;
+int generator_threads = 1;
+int batch_process_size = 1;
+std::string log_output = "combined"; // PRINT log: "none", "combined" (csopesy-print-log.txt) or "per-process" (<name>.txt)
+std::string log_full_policy = "drop"; // when the log ring is full: "drop" the record or "block" the core
+int log_buffer_size = 65536; // log ring capacity in records (rounded up to a power of two)
+int archive_size = 10000; // finished-process summaries kept per scheduler, oldest dropped first
 
-std::map<std::string, Process*> readyProcesses;
-std::map<std::string, Process*> runningProcessesMap;
-std::map<std::string, Process*> finishedProcessesMap;
 
 std::queue<Process*> readyQueue;
 std::mutex queueMutex;
@@ -157,87 +178,64 @@ std::atomic<bool> schedulerActive{false};
 
 std::stringstream outputBuffer;
 
-std::string getCurrentTimestamp() {
-    std::time_t now = std::time(nullptr);
-    std::tm localTime;
-#ifdef _WIN32
-    localtime_s(&localTime, &now);
-#else
-    localtime_r(&now, &localTime);
-#endif
-    std::ostringstream oss;
-    oss << std::put_time(&localTime, "%m/%d/%Y, %I:%M:%S %p");
-    return oss.str();
+// Creation time of a process made from the console, on the active scheduler's clock
+Timestamp processTimestamp() {
+    if (scheduler == "fcfs" && fcfsScheduler && fcfsScheduler->isRunning()) {
+        return Timestamp::now(fcfsScheduler->currentTick());
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler && rrScheduler->isRunning()) {
+        return Timestamp::now(rrScheduler->currentTick());
+    }
+    return Timestamp::now();
 }
 
-void updateProcessMaps() {
-    // Clear and repopulate maps from scheduler's vectors
-    runningProcessesMap.clear();
-    finishedProcessesMap.clear();
-    readyProcesses.clear();
-
-    if(fcfsScheduler){
-        auto running = fcfsScheduler->getRunningProcesses();
-        auto finished = fcfsScheduler->getFinishedProcesses();
-        auto ready = fcfsScheduler->getReadyProcesses();
-        for (auto* proc : running) {
-            runningProcessesMap[proc->getName()] = proc;
-        }
-        for (auto* proc : finished) {
-            finishedProcessesMap[proc->getName()] = proc;
-        }
-        for (auto* proc : ready) {
-            readyProcesses[proc->getName()] = proc;
-        }
-    }else if(rrScheduler) {
-        auto running = rrScheduler->getRunningProcesses();
-        auto finished = rrScheduler->getFinishedProcesses();
-        auto ready = rrScheduler->getReadyProcesses();
-        for (auto* proc : running) {
-            runningProcessesMap[proc->getName()] = proc;
-        }
-        for (auto* proc : finished) {
-            finishedProcessesMap[proc->getName()] = proc;
-        }
-        for (auto* proc : ready) {
-            readyProcesses[proc->getName()] = proc;
-        }
+// Live processes only (see findFinishedProcess). Dereference the result only under a ProcessReclaimer::Guard.
+Process* findProcess(const std::string& processName) {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->findLiveProcess(processName);
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->findLiveProcess(processName);
     }
-
+    return nullptr;
 }
 
-Process* findProcess(const std::string& processName) {
-    updateProcessMaps();
-    Process* proc = nullptr;
-    // Check running first, then finished
-    if (runningProcessesMap.count(processName)) {
-        proc = runningProcessesMap[processName];
-    } else if (finishedProcessesMap.count(processName)) {
-        proc = finishedProcessesMap[processName];
-    }else if(readyProcesses.count(processName)) {
-        proc = readyProcesses[processName];
+bool findNameByPid(int pid, std::string& name) {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->findNameByPid(pid, name);
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->findNameByPid(pid, name);
     }
+    return false;
+}
 
-    if (!proc) {
-        return nullptr;
+bool findFinishedProcess(const std::string& processName, ProcessSummary& out) {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->findFinishedProcess(processName, out);
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->findFinishedProcess(processName, out);
     }
-    
-    return proc;
+    return false;
 }
 
 void drawScreen(const std::string& processName) {
+    ProcessReclaimer::Guard guard;
     Process* proc = findProcess(processName);
-    
-    if(!proc) {
+    ProcessSummary summary;
+
+    if (proc) {
+        std::cout << "\n=== Attached to Screen: " << proc->getName() << " ===\n";
+        std::cout << "Process Name         : " << proc->getName() << "\n";
+        std::cout << "Instruction Line     : " << proc->getCurrentLine() << " / " << proc->getTotalLines() << "\n";
+        std::cout << "Created At           : " << formatTime(proc->getTimestamp(), TimeFormat::Display) << "\n";
+    } else if (findFinishedProcess(processName, summary)) {
+        std::cout << "\n=== Attached to Screen: " << summary.name << " ===\n";
+        std::cout << "Process Name         : " << summary.name << "\n";
+        std::cout << "Instruction Line     : " << summary.totalLines << " / " << summary.totalLines << "\n";
+        std::cout << "Created At           : " << formatTime(summary.timestamp, TimeFormat::Display) << "\n";
+        std::cout << "Finished At          : " << formatTime(summary.endTime, TimeFormat::Display) << "\n";
+    } else {
         std::cout << "Error: Process not found.\n";
         return;
     }
-
-    std::cout << "\n=== Attached to Screen: " << proc->getName() << " ===\n";
-    std::cout << "Process Name         : " << proc->getName() << "\n";
-    int currentLineDisplay = proc->getStatus() == "Finished" ? proc->getTotalLines() : proc->getCurrentLine();
-    std::cout << "Instruction Line     : " << currentLineDisplay << " / " << proc->getTotalLines() << "\n";
-    std::cout << "Created At           : " << proc->getTimestamp() << "\n";
     std::cout << "------------------------------------------\n";
     std::cout << "Type 'exit' to return to the main menu.\n\n";
 }
@@ -245,28 +243,42 @@ void drawScreen(const std::string& processName) {
 void executeScreen(const std::string& processName){
     if(scheduler == "fcfs" && !fcfsScheduler->isRunning()) {
         fcfsScheduler->start();
-    } else if(scheduler == "rr" && !rrScheduler->isRunning()) {
+    } else if((scheduler == "rr" || scheduler == "cfs") && !rrScheduler->isRunning()) {
         rrScheduler->start();
     }
 
-    Process* proc = findProcess(processName);
+    // The process may finish and be reclaimed while the screen is open, so it is looked up
+    // again (under a guard) for every command rather than held across them
     std::string input;
+    {
+        ProcessReclaimer::Guard guard;
+        if (Process* proc = findProcess(processName)) proc->setAttached(true);
+    }
     
     while (true) {
-        std::cout << proc->getName() << " > ";
+        std::cout << processName << " > ";
         std::getline(std::cin, input);
         if (input == "exit") {
             break;
         } 
         else if(input == "process-smi"){
-            std::cout << "Process name: " << proc->getName() << "\n";
-            std::cout << "ID: " << proc->getPid() << "\n";
-            std::cout << "Logs: \n";
-            std::vector<std::string> logs = proc->getAllLogs();
-            for(const auto& log : logs) {
-                std::cout << log << "\n";
+            ProcessReclaimer::Guard guard;
+            ProcessSummary summary;
+            if (Process* proc = findProcess(processName)) {
+                std::cout << "Process name: " << proc->getName() << "\n";
+                std::cout << "ID: " << proc->getPid() << "\n";
+                std::cout << "Logs: \n";
+                proc->visitLogs(SIZE_MAX, [](const std::string& log) { std::cout << log << "\n"; });
+                proc->printLog();
+            } else if (findFinishedProcess(processName, summary)) {
+                std::cout << "Process name: " << summary.name << "\n";
+                std::cout << "ID: " << summary.pid << "\n";
+                std::cout << "Logs: \n";
+                for(const auto& log : summary.logTail) {
+                    std::cout << log << "\n";
+                }
+                std::cout << "Finished!\n";
             }
-            proc->printLog();
         }
         else {
             if (input.substr(0, 6) == "PRINT(" && input.back() == ')') {
@@ -275,9 +287,36 @@ void executeScreen(const std::string& processName){
             }
         }
     }
+    {
+        ProcessReclaimer::Guard guard;
+        if (Process* proc = findProcess(processName)) proc->setAttached(false);
+    }
     std::system("CLS");
 }
 
+// A config value out of range (or not a number) is reported and the key keeps its current value
+void readConfigInt(std::istringstream& iss, const std::string& key, int& value, int min, int max = std::numeric_limits<int>::max()) {
+    int parsed;
+    if (iss >> parsed && parsed >= min && parsed <= max) {
+        value = parsed;
+        return;
+    }
+    std::cout << "Config: invalid value for " << key << ", keeping " << value << "\n";
+}
+
+void readConfigChoice(std::istringstream& iss, const std::string& key, std::string& value, std::initializer_list<const char*> choices) {
+    std::string parsed;
+    if (iss >> std::quoted(parsed)) {
+        for (const char* choice : choices) {
+            if (parsed == choice) {
+                value = parsed;
+                return;
+            }
+        }
+    }
+    std::cout << "Config: invalid value for " << key << ", keeping \"" << value << "\"\n";
+}
+
 void loadConfig(const std::string& filename) {
     
     std::ifstream infile(filename);
@@ -286,20 +325,59 @@ void loadConfig(const std::string& filename) {
         std::istringstream iss(line);
         std::string key;
         if (iss >> key) {
-            if (key == "num-cpu") iss >> num_cpu;
-            else if (key == "scheduler") iss >> std::quoted(scheduler);
-            else if (key == "quantum-cycles") iss >> quantum_cycles;
-            else if (key == "batch-process-freq") iss >> batch_process_freq;
-            else if (key == "min-ins") iss >> min_ins;
-            else if (key == "max-ins") iss >> max_ins;
-            else if (key == "delay-per-exec") iss >> delay_per_exec;
-            else if (key == "max-overall-mem") iss >> max_overall_mem;
-            else if (key == "mem-per-frame") iss >> mem_per_frame;
-            else if (key == "min-mem-per-proc") iss >> min_mem_per_proc;
-            else if (key == "max-mem-per-proc") iss >> max_mem_per_proc;
+            if (key == "num-cpu") readConfigInt(iss, key, num_cpu, 1, 4096);
+            else if (key == "scheduler") readConfigChoice(iss, key, scheduler, {"fcfs", "rr", "cfs"});
+            else if (key == "quantum-cycles") readConfigInt(iss, key, quantum_cycles, 1);
+            else if (key == "batch-process-freq") readConfigInt(iss, key, batch_process_freq, 0);
+            else if (key == "min-ins") readConfigInt(iss, key, min_ins, 1);
+            else if (key == "max-ins") readConfigInt(iss, key, max_ins, 1);
+            else if (key == "delay-per-exec") readConfigInt(iss, key, delay_per_exec, 0);
+            else if (key == "max-overall-mem") readConfigInt(iss, key, max_overall_mem, 1);
+            else if (key == "mem-per-frame") readConfigInt(iss, key, mem_per_frame, 1);
+            else if (key == "min-mem-per-proc") readConfigInt(iss, key, min_mem_per_proc, 1);
+            else if (key == "max-mem-per-proc") readConfigInt(iss, key, max_mem_per_proc, 1);
+            else if (key == "target-latency") readConfigInt(iss, key, target_latency, 0);
+            else if (key == "min-granularity") readConfigInt(iss, key, min_granularity, 1);
+            else if (key == "default-weight") readConfigInt(iss, key, default_weight, 1);
+            else if (key == "migration-cost") readConfigInt(iss, key, migration_cost, 0);
+            else if (key == "balance-interval") readConfigInt(iss, key, balance_interval, 0);
+            else if (key == "balance-threshold") readConfigInt(iss, key, balance_threshold, 1);
+            else if (key == "quantum-mode") readConfigChoice(iss, key, quantum_mode, {"fixed", "adaptive"});
+            else if (key == "min-quantum") readConfigInt(iss, key, min_quantum, 1);
+            else if (key == "max-quantum") readConfigInt(iss, key, max_quantum, 0);
+            else if (key == "page-fault-ticks") readConfigInt(iss, key, page_fault_ticks, 0);
+            else if (key == "program-generation") readConfigChoice(iss, key, program_generation, {"eager", "lazy"});
+            else if (key == "program-optimization") readConfigChoice(iss, key, program_optimization, {"none", "peephole"});
+            else if (key == "execution-mode") readConfigChoice(iss, key, execution_mode, {"scalar", "batch"});
+            else if (key == "ticks-per-step") readConfigInt(iss, key, ticks_per_step, 1);
+            else if (key == "seed") {
+                random_seed_set = static_cast<bool>(iss >> random_seed);
+                if (!random_seed_set) std::cout << "Config: invalid value for seed, using a random one\n";
+            }
+            else if (key == "generator-threads") readConfigInt(iss, key, generator_threads, 1);
+            else if (key == "batch-process-size") readConfigInt(iss, key, batch_process_size, 1);
+            else if (key == "log-output") readConfigChoice(iss, key, log_output, {"none", "combined", "per-process"});
+            else if (key == "log-full-policy") readConfigChoice(iss, key, log_full_policy, {"drop", "block"});
+            else if (key == "log-buffer-size") readConfigInt(iss, key, log_buffer_size, 1);
+            else if (key == "archive-size") readConfigInt(iss, key, archive_size, 1);
+            else std::cout << "Config: unknown key " << key << "\n";
         }
     }
 
+    if (max_ins < min_ins) {
+        std::cout << "Config: max-ins is below min-ins, using " << min_ins << "\n";
+        max_ins = min_ins;
+    }
+    if (max_mem_per_proc < min_mem_per_proc) {
+        std::cout << "Config: max-mem-per-proc is below min-mem-per-proc, using " << min_mem_per_proc << "\n";
+        max_mem_per_proc = min_mem_per_proc;
+    }
+
+    // Without a seed key every run gets a fresh workload
+    if (!random_seed_set) {
+        random_seed = (static_cast<std::uint64_t>(std::random_device{}()) << 32) ^ static_cast<std::uint64_t>(std::time(nullptr));
+    }
+
     /* std::cout << num_cpu;
     std::cout << scheduler;
     std::cout << quantum_cycles;
@@ -316,7 +394,7 @@ void loadConfig(const std::string& filename) {
         int tick = ++cpuTick;
         if (batch_process_freq > 0 && tick % batch_process_freq == 0) {
             std::string processName = "auto_proc_" + std::to_string(tick);
-            Process* newProcess = new Process(processName, 0, 100, getCurrentTimestamp(), "Ready");
+            Process* newProcess = new Process(processName, 0, 100, processTimestamp(), "Ready");
             newProcess->create100PrintCommands();
             fcfsScheduler->addProcess(newProcess);
         }
@@ -326,7 +404,7 @@ void loadConfig(const std::string& filename) {
 /* void createSampleProcesses(){
     for (int i = 0; i < 10; ++i) {
         std::string processName = std::string("process") + (i < 9 ? "0" : "") + std::to_string(i+1);
-        Process* newProcess = new Process(curr_id, processName, 0, 100, getCurrentTimestamp(), "Attached");
+        Process* newProcess = new Process(curr_id, processName, 0, 100, processTimestamp(), "Attached");
         ++curr_id;
         newProcess->createPrintCommands(100);
         fcfsScheduler->addProcess(newProcess);
@@ -336,7 +414,7 @@ void loadConfig(const std::string& filename) {
 float getCpuUtilization() {
     if (scheduler == "fcfs") {
         return fcfsScheduler->getCpuUtilization();
-    } else if (scheduler == "rr") {
+    } else if (scheduler == "rr" || scheduler == "cfs") {
         return rrScheduler->getCpuUtilization();
     }
     return 0.0f;
@@ -345,7 +423,7 @@ float getCpuUtilization() {
 int getBusyCores() {
     if (scheduler == "fcfs") {
         return fcfsScheduler->getBusyCores();
-    } else if (scheduler == "rr") {
+    } else if (scheduler == "rr" || scheduler == "cfs") {
         return rrScheduler->getBusyCores();
     }
     return 0;
@@ -354,61 +432,230 @@ int getBusyCores() {
 int getAvailableCores() {
     if (scheduler == "fcfs") {
         return fcfsScheduler->getAvailableCores();
-    } else if (scheduler == "rr") {
+    } else if (scheduler == "rr" || scheduler == "cfs") {
         return rrScheduler->getAvailableCores();
     }
     return 0;
 }
 
-void screenLS(std::vector<Process*> running, std::vector<Process*> finished) {
-    // Sort running processes by name
-    std::sort(running.begin(), running.end(), [](Process* a, Process* b) {
-        return a->getName() < b->getName();
-    });
+std::vector<std::pair<Process*, int>> getSleepingProcesses() {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->getSleepingProcesses();
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->getSleepingProcesses();
+    }
+    return {};
+}
 
-    // Sort finished processes by end time (earliest first)
-    std::sort(finished.begin(), finished.end(), [](Process* a, Process* b) {
-        return a->getEndTime() < b->getEndTime();
-    });
+SchedulerMetrics getSchedulerMetrics() {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->getMetrics();
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->getMetrics();
+    }
+    return SchedulerMetrics();
+}
+
+void printSchedulerMetrics(std::ostream& out) {
+    SchedulerMetrics metrics = getSchedulerMetrics();
+    out << "Scheduling metrics (" << metrics.turnaround.count() << " finished processes, in ticks):\n";
+    out << std::left << std::setw(12) << "" << std::right
+        << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+        << std::setw(10) << "max" << std::setw(12) << "mean" << "\n";
+    auto row = [&out](const char* label, const LatencyHistogram& h) {
+        out << std::left << std::setw(12) << label << std::right
+            << std::setw(10) << h.percentile(50) << std::setw(10) << h.percentile(90)
+            << std::setw(10) << h.percentile(99) << std::setw(10) << h.max()
+            << std::setw(12) << std::fixed << std::setprecision(1) << h.mean() << "\n";
+    };
+    row("Response", metrics.response);
+    row("Waiting", metrics.waiting);
+    row("Turnaround", metrics.turnaround);
+    row("Dispatches", metrics.dispatches);
+    out << std::defaultfloat << std::setprecision(6);
+}
+
+std::vector<Process*> getRunningProcesses() {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->getRunningProcesses();
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->getRunningProcesses();
+    }
+    return {};
+}
+
+bool getFinishedProcesses(const ArchiveQuery& query, std::vector<ProcessSummary>& out) {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->getFinishedProcesses(query, out);
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->getFinishedProcesses(query, out);
+    }
+    return false;
+}
+
+size_t getFinishedCount() {
+    if (scheduler == "fcfs" && fcfsScheduler) {
+        return fcfsScheduler->getFinishedCount();
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
+        return rrScheduler->getFinishedCount();
+    }
+    return 0;
+}
+
+// What screen -ls shows. --limit caps every section, --offset pages back through the finished history.
+struct ListOptions {
+    ArchiveQuery finished;
+    bool running = true;
+    bool sleeping = true;
+    bool summaryOnly = false;
+};
+
+// screen -ls [--limit n] [--offset n] [--state running|sleeping|finished]... [--prefix name] [--summary]
+bool parseListOptions(const std::vector<std::string>& args, ListOptions& opts) {
+    bool stateGiven = false;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+        if (arg == "--summary") {
+            opts.summaryOnly = true;
+        } else if ((arg == "--limit" || arg == "--offset") && hasValue) {
+            long long value = -1;
+            try { value = std::stoll(args[++i]); } catch (...) {}
+            if (value < 0 || (arg == "--limit" && value == 0)) return false;
+            (arg == "--limit" ? opts.finished.limit : opts.finished.offset) = static_cast<size_t>(value);
+        } else if (arg == "--prefix" && hasValue) {
+            opts.finished.prefix = args[++i];
+        } else if (arg == "--state" && hasValue) {
+            if (!stateGiven) {
+                opts.running = opts.sleeping = opts.finished.finished = false;
+                stateGiven = true;
+            }
+            const std::string& state = args[++i];
+            if (state == "running") opts.running = true;
+            else if (state == "sleeping") opts.sleeping = true;
+            else if (state == "finished") opts.finished.finished = true;
+            else return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Keeps one page of the live processes whose name starts with prefix: the first offset of them
+// skipped, at most limit kept. Returns how many follow the page.
+template <typename T, typename Name>
+size_t filterLive(std::vector<T>& procs, const ListOptions& opts, Name name) {
+    const std::string& prefix = opts.finished.prefix;
+    procs.erase(std::remove_if(procs.begin(), procs.end(), [&](const T& p) {
+        return name(p).compare(0, prefix.size(), prefix) != 0;
+    }), procs.end());
+    procs.erase(procs.begin(), procs.begin() + std::min(procs.size(), opts.finished.offset));
+    size_t cut = procs.size() > opts.finished.limit ? procs.size() - opts.finished.limit : 0;
+    procs.resize(procs.size() - cut);
+    return cut;
+}
+
+// Holds its own ProcessReclaimer::Guard over the live processes it formats
+void screenLS(const ListOptions& opts) {
+    ProcessReclaimer::Guard guard;
+    std::vector<Process*> running = opts.running ? getRunningProcesses() : std::vector<Process*>();
+    std::vector<std::pair<Process*, int>> sleeping = opts.sleeping ? getSleepingProcesses() : std::vector<std::pair<Process*, int>>();
     outputBuffer.str(""); // Clear the output buffer
 
     outputBuffer << "CPU Utilization: " << getCpuUtilization() << "%" << "\n";
     outputBuffer << "Cores Used: " << getBusyCores() << "\n";
     outputBuffer << "Cores Available: " << getAvailableCores() << "\n";
-
+    if (rrScheduler) {
+        std::vector<int> loads = rrScheduler->getCoreLoads();
+        outputBuffer << "Core loads:";
+        for (size_t c = 0; c < loads.size(); ++c) {
+            outputBuffer << "  [" << c << "] " << loads[c];
+        }
+        outputBuffer << "\nMigrations: " << rrScheduler->getMigrations() << "\n";
+    }
     outputBuffer << "----------------------------------------\n";
-    outputBuffer << "Running processes:\n";
-    for (auto* proc : running) {
-        outputBuffer << std::left << std::setw(12) << proc->getName()
-                << " (" << proc->getTimestamp() << ")"
-                << "    Core: " << proc->getCpuId()
-                << "    " << proc->getCurrentLine() << " / " << proc->getTotalLines() << "\n";
-    }
-    outputBuffer << "\nFinished processes:\n";
-    for (auto* proc : finished) {
-        std::string status = proc->getStatus();
-        if (status.find("Terminated") != std::string::npos) {
+
+    if (opts.summaryOnly) {
+        outputBuffer << "Running: " << running.size()
+            << "    Sleeping: " << sleeping.size()
+            << "    Finished: " << getFinishedCount() << "\n";
+        outputBuffer << "----------------------------------------\n";
+        return;
+    }
+
+    // Sort running processes by name
+    std::sort(running.begin(), running.end(), [](Process* a, Process* b) {
+        return a->getName() < b->getName();
+    });
+    size_t runningCut = filterLive(running, opts, [](Process* p) -> const std::string& { return p->getName(); });
+    if (opts.running) {
+        outputBuffer << "Running processes:\n";
+        for (auto* proc : running) {
             outputBuffer << std::left << std::setw(12) << proc->getName()
-                << " (" << proc->getEndTime() << ")"
-                << "    Terminated    " << proc->getCurrentLine() << " / " << proc->getTotalLines() << "\n";
-        } else {
+                    << " (" << formatTime(proc->getTimestamp(), TimeFormat::Display) << ")"
+                    << "    Core: " << proc->getCpuId()
+                    << "    " << proc->getCurrentLine() << " / " << proc->getTotalLines()
+                    << "    Migrations: " << proc->getMigrations() << "\n";
+        }
+        if (runningCut) outputBuffer << "(" << runningCut << " more)\n";
+    }
+
+    std::sort(sleeping.begin(), sleeping.end(), [](const auto& a, const auto& b) {
+        return a.second < b.second;
+    });
+    size_t sleepingCut = filterLive(sleeping, opts, [](const std::pair<Process*, int>& p) -> const std::string& { return p.first->getName(); });
+    if (!sleeping.empty()) {
+        outputBuffer << "\nSleeping processes:\n";
+        for (const auto& [proc, remaining] : sleeping) {
             outputBuffer << std::left << std::setw(12) << proc->getName()
-                << " (" << proc->getEndTime() << ")"
-                << "    Finished    " << proc->getTotalLines() << " / " << proc->getTotalLines() << "\n";
+                    << " (" << formatTime(proc->getTimestamp(), TimeFormat::Display) << ")"
+                    << "    Waking in: " << remaining << " ticks"
+                    << "    " << proc->getCurrentLine() << " / " << proc->getTotalLines() << "\n";
+        }
+        if (sleepingCut) outputBuffer << "(" << sleepingCut << " more)\n";
+    }
+
+    if (opts.finished.finished) {
+        // The archive is already in completion order, oldest first
+        std::vector<ProcessSummary> finished;
+        bool more = getFinishedProcesses(opts.finished, finished);
+        size_t dropped = 0; // older than the archive keeps
+        if (opts.finished.filtered()) {
+            // Only the page is scanned for, so the total number of matches is not known
+            outputBuffer << "\nMatching finished processes (page of " << finished.size()
+                << ", offset " << opts.finished.offset << "):\n";
+        } else {
+            size_t total = getFinishedCount();
+            size_t end = total > opts.finished.offset ? total - opts.finished.offset : 0;
+            size_t first = end > finished.size() ? end - finished.size() : 0;
+            if (!more) dropped = first;
+            outputBuffer << "\nFinished processes (" << (finished.empty() ? 0 : first + 1) << "-" << first + finished.size()
+                << " of " << total << "):\n";
+        }
+        for (const auto& proc : finished) {
+            outputBuffer << std::left << std::setw(12) << proc.name
+                << " (" << formatTime(proc.endTime, TimeFormat::Display) << ")"
+                << "    Finished    " << proc.totalLines << " / " << proc.totalLines << "\n";
+        }
+        if (more) {
+            outputBuffer << "(older entries: --offset " << opts.finished.offset + opts.finished.limit << ")\n";
+        } else if (dropped) {
+            outputBuffer << "(" << dropped << " older entries are no longer kept, see archive-size)\n";
         }
     }
     outputBuffer << "----------------------------------------\n";
 }
 
 void reportUtil(){
-    if(scheduler == "fcfs"){
-        std::vector<Process*> running = fcfsScheduler->getRunningProcesses();
-        std::vector<Process*> finished = fcfsScheduler->getFinishedProcesses();
-        screenLS(running, finished);
-    }else if(scheduler == "rr"){
-        std::vector<Process*> running = rrScheduler->getRunningProcesses();
-        std::vector<Process*> finished = rrScheduler->getFinishedProcesses();
-        screenLS(running, finished);
+    // The report keeps the whole history
+    ListOptions opts;
+    opts.finished.limit = std::numeric_limits<size_t>::max();
+    screenLS(opts);
+    outputBuffer << "\n";
+    printSchedulerMetrics(outputBuffer);
+    if (logSink.getDropped() > 0) {
+        outputBuffer << "\nPRINT log records dropped (ring full): " << logSink.getDropped() << "\n";
     }
 
     std::ofstream reportFile("csopesy-log.txt");
@@ -471,13 +718,15 @@ void headerText () {
         "Hello, Welcome to the CSOPESY command line emulator!\n"
         "Type:\n"
         "-'initialize'\n"
-        "-'screen -s <name>' to create a session\n"
-        "-'screen -r <name>' to resume a session\n"
-        "-'screen -ls' to view all attached or detached sessions\n"
+        "-'screen -s <name> <mem> [-w <weight>]' to create a session\n"
+        "-'screen -r <name|pid>' to resume a session\n"
+        "-'screen -ls [--limit n] [--offset n] [--state s] [--prefix p] [--summary]' to view sessions\n"
         "-'screen -d <name>' to detach a running session\n"
         "-'scheduler-start'\n"
         "-'scheduler-stop'\n"
         "-'report-util'\n"
+        "-'quantum-cycles <n>' to change the RR quantum live\n"
+        "-'sched-stats' to view response, waiting and turnaround percentiles\n"
         "-'clear' to clear the screen\n"
         "-'exit' to quit\n"
         "\n";
@@ -496,7 +745,6 @@ void headerText () {
                 std::cout << "Emulator has already been initialized.\n";
             }
             else if (command == "report-util") {
-                updateProcessMaps();
                 reportUtil();
             }
             else if (command == "screen") {
@@ -511,30 +759,42 @@ void headerText () {
                         iss >> procSize;
                         int memSize = std::stoi(procSize);
 
-                        if(isValidMemorySize(memSize)) {
+                        // Optional CFS share: screen -s <name> <mem> -w <weight>
+                        int weight = default_weight;
+                        bool weightValid = true;
+                        std::string flag;
+                        if (iss >> flag) {
+                            weightValid = flag == "-w" && (iss >> weight) && weight > 0;
+                        }
+
+                        if (!weightValid) {
+                            std::cout << "Usage: screen -s <name> <mem> [-w <positive weight>]\n";
+                        } else if(isValidMemorySize(memSize)) {
                             std::cout << "Memory is valid.\n";
 
                             Process *proc = findProcess(sessionName);
-                            if (proc == nullptr) {
-                                int numInstructions = min_ins + (std::rand() % (max_ins - min_ins + 1));
+                            ProcessSummary summary;
+                            if (proc == nullptr && !findFinishedProcess(sessionName, summary)) {
+                                SplitMix64 stream(SplitMix64::streamSeed(random_seed, static_cast<std::uint64_t>(curr_id)));
+                                int numInstructions = stream.range(min_ins, max_ins);
 
                                 Process* newSession = new Process(
                                     curr_id,
                                     sessionName,
                                     0,
                                     numInstructions,
-                                    getCurrentTimestamp(),
-                                    "Ready",
+                                    processTimestamp(),
                                     memSize
                                 );
 
-                                newSession->createPrintCommands(numInstructions);
+                                newSession->setWeight(weight);
+                                newSession->createPrintCommands(numInstructions, stream.next());
                                 ++curr_id;
                                 
                                 // Add to scheduler
                                 if(scheduler == "fcfs"){
                                     fcfsScheduler->addProcess(newSession);
-                                }else if(scheduler == "rr"){
+                                }else if(scheduler == "rr" || scheduler == "cfs"){
                                     rrScheduler->addProcess(newSession);
                                 }
 
@@ -550,8 +810,14 @@ void headerText () {
                             std::cout << "Invalid memory size. Must be a power of 2.\n";
                         }
                     } else if (option == "-r") {
-                        Process *proc = findProcess(sessionName);
-                        if (proc != nullptr) {
+                        ProcessSummary summary;
+                        bool found = findProcess(sessionName) != nullptr || findFinishedProcess(sessionName, summary);
+                        // No session by that name: try it as a pid
+                        if (!found && sessionName.size() < 10
+                            && std::all_of(sessionName.begin(), sessionName.end(), [](unsigned char c) { return std::isdigit(c); })) {
+                            found = findNameByPid(std::stoi(sessionName), sessionName);
+                        }
+                        if (found) {
                             std::system("CLS");
                             drawScreen(sessionName);
                             executeScreen(sessionName);
@@ -567,23 +833,23 @@ void headerText () {
                         std::vector<std::vector<std::string>> commandTokens = tokenizeCommands(tokens[3]);
 
                         /*Process(int pid, const std::string& name, int currentLine, 
-                        const std::string& timestamp, const std::string& status, 
-                        int memSize, std::vector<std::vector<std::string>> commandS); */
+                        const std::string& timestamp, int memSize,
+                        std::vector<std::vector<std::string>> commandS); */
 
                         Process* newSession = new Process(
                             curr_id,
                             sessionName,
                             0,
-                            getCurrentTimestamp(),
-                            "Ready",
+                            processTimestamp(),
                             512,
                             commandTokens
                         );
+                        ++curr_id;
 
                         // Add to scheduler
                         if(scheduler == "fcfs"){
                             fcfsScheduler->addProcess(newSession);
-                        }else if(scheduler == "rr"){
+                        }else if(scheduler == "rr" || scheduler == "cfs"){
                             rrScheduler->addProcess(newSession);
                         }
 
@@ -627,7 +893,7 @@ void headerText () {
                                     sessionName,
                                     0,
                                     instructions.size(),
-                                    getCurrentTimestamp(),
+                                    processTimestamp(),
                                     "Ready",
                                     memSize
                                 );
@@ -637,30 +903,30 @@ void headerText () {
                         } */
                     }
                 } else if(option == "-ls"){
-                    if(scheduler == "fcfs"){
-                        std::vector<Process*> running = fcfsScheduler->getRunningProcesses();
-                        std::vector<Process*> finished = fcfsScheduler->getFinishedProcesses();
-                        screenLS(running, finished);
-                        std::cout << outputBuffer.str();
-                    }
-                    else if(scheduler == "rr"){
-                        updateProcessMaps();
-                        std::vector<Process*> running = rrScheduler->getRunningProcesses();
-                        std::vector<Process*> finished = rrScheduler->getFinishedProcesses();
-                        screenLS(running, finished);
+                    // sessionName already took the first option word
+                    std::vector<std::string> args;
+                    if (!sessionName.empty()) args.push_back(sessionName);
+                    for (std::string arg; iss >> arg;) args.push_back(arg);
+                    ListOptions opts;
+                    if (!parseListOptions(args, opts)) {
+                        std::cout << "Usage: screen -ls [--limit n] [--offset n] [--state running|sleeping|finished] [--prefix name] [--summary]\n";
+                    } else if (fcfsScheduler || rrScheduler) {
+                        screenLS(opts);
                         std::cout << outputBuffer.str();
                     }
                 } else if (option == "-d") {
+                    ProcessReclaimer::Guard guard;
                     Process *current = findProcess(sessionName);
-                    if (current != nullptr) {
+                    ProcessSummary summary;
+                    if (current == nullptr && findFinishedProcess(sessionName, summary)) {
+                        std::cout << "Error: Session \"" << summary.name << "\" is already detached.\n";
+                    } else if (current != nullptr) {
                         //Process& current = sessions[sessionName];
-                        if (current->getStatus() == "Detached") {
+                        if (!current->isAttached()) {
                             std::cout << "Error: Session \"" << current->getName() << "\" is already detached.\n";
-                        } else if (current->getStatus() == "Attached") {
-                            current->setStatus("Detached");
-                            std::cout << current->getName() << " has been detached successfully.\n";
                         } else {
-                            std::cout << "Error: Unknown session status.\n";
+                            current->setAttached(false);
+                            std::cout << current->getName() << " has been detached successfully.\n";
                         }
                     } else {
                         std::cout << "Error: Session \"" << sessionName << "\" does not exist.\n";
@@ -711,12 +977,27 @@ void headerText () {
             }
             else if (command == "exit") {
                 std::cout << "exit command recognized. exiting...\n";
-                fcfsScheduler->stop();
-                rrScheduler->stop();
+                if (fcfsScheduler) fcfsScheduler->stop();
+                if (rrScheduler) rrScheduler->stop();
                 delete fcfsScheduler;
                 delete rrScheduler;
+                logSink.stop();
                 exit(0);
             }
+            else if (command == "quantum-cycles") {
+                int cycles = 0;
+                if (!(iss >> cycles) || cycles <= 0) {
+                    std::cout << "Usage: quantum-cycles <positive number>\n";
+                } else if (scheduler == "cfs") {
+                    std::cout << "CFS slices come from target-latency and min-granularity; quantum-cycles has no effect.\n";
+                } else if (rrScheduler) {
+                    rrScheduler->setQuantumCycles(cycles);
+                    quantum_cycles = cycles;
+                    std::cout << "Quantum set to " << cycles << " cycles.\n";
+                } else {
+                    std::cout << "The current scheduler does not use a quantum.\n";
+                }
+            }
             else if (command == "vmstat"){
                 if(rrScheduler && rrScheduler->isRunning()){
                     rrScheduler->printVMStat();
@@ -724,6 +1005,13 @@ void headerText () {
                     fcfsScheduler->printVMStat();
                 }
             }
+            else if (command == "sched-stats"){
+                if ((fcfsScheduler && fcfsScheduler->isRunning()) || (rrScheduler && rrScheduler->isRunning())) {
+                    printSchedulerMetrics(std::cout);
+                } else {
+                    std::cout << "No scheduler is running.\n";
+                }
+            }
             else if (command == "process-smi"){
                 if(rrScheduler && rrScheduler->isRunning()){
                     rrScheduler->printProcessSMI();
@@ -745,17 +1033,14 @@ void addAndRunProcess(Process* proc) {
     if (scheduler == "fcfs" && fcfsScheduler) {
         fcfsScheduler->addProcess(proc);
         // No explicit notify needed, FCFS addProcess already notifies
-    } else if (scheduler == "rr" && rrScheduler) {
+    } else if ((scheduler == "rr" || scheduler == "cfs") && rrScheduler) {
         rrScheduler->addProcess(proc);
         // No explicit notify needed, RR addProcess already notifies
     }
     // The scheduler's addProcess already calls cv.notify_all(), so workers will wake up immediately
 }
 
-std::mt19937 rng; // Define the random number generator
-
 int main() {
-    rng.seed(static_cast<unsigned int>(std::time(nullptr))); // Seed once
     std::system("CLS");
     bool init = false;
     std::string in;
@@ -766,14 +1051,25 @@ int main() {
         if(in == "initialize") {
             loadConfig("config.txt");
             in = true;
+            logSink.start(log_output == "per-process" ? LogSink::Output::PerProcess
+                              : log_output == "combined" ? LogSink::Output::Combined : LogSink::Output::None,
+                          log_full_policy == "block" ? LogSink::FullPolicy::Block : LogSink::FullPolicy::Drop,
+                          static_cast<size_t>(std::max(1, log_buffer_size)));
 
             if(scheduler == "fcfs") {
                 fcfsScheduler = new FCFSScheduler(num_cpu);
                 break;
             }else if(scheduler == "rr"){
                 rrScheduler = new RRScheduler(num_cpu, quantum_cycles);
+                if (quantum_mode == "adaptive") {
+                    rrScheduler->setAdaptiveQuantum(min_quantum, max_quantum > 0 ? max_quantum : quantum_cycles * 4);
+                }
                 break;
-            } 
+            }else if(scheduler == "cfs"){
+                rrScheduler = new RRScheduler(num_cpu, quantum_cycles);
+                rrScheduler->setFairScheduling(target_latency, min_granularity);
+                break;
+            }
             else {
                 std::cout << "Error: Unsupported scheduler type.\n";
                 break;